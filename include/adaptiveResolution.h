@@ -0,0 +1,64 @@
+#pragma once
+#include <glad/glad.h>
+#include "config.h"
+#include "shaderClass.h"
+#include "bufferObjects.h"
+
+#define MIN_RENDER_SCALE     0.25f // Smallest fraction of the window an adaptive pass renders at
+#define RESOLUTION_HEADROOM  0.85f // Share of the frame the scaled pass may spend on the GPU
+#define RESOLUTION_DEADBAND  0.05f // Relative scale change too small to act on
+#define TEMPORAL_FEEDBACK    0.75f // Weight of the history when blending upscaled frames
+#define UPSCALE_SHARPNESS    0.5f  // Strength of the SHARPEN filter
+#define GPU_TIMER_QUERIES    4     // Frames a timer result may lag, so reading one never stalls
+
+enum class UpscaleFilter {
+    BILINEAR,
+    SHARPEN  // Bilinear, then an unsharp mask clamped to the neighbourhood
+};
+
+struct ResolutionSettings {
+    float fixed_scale = 0.0f;  // Render at this fraction of the window, 0 adapts to target_fps
+    float target_fps  = 60.0f;
+    UpscaleFilter filter = UpscaleFilter::BILINEAR;
+    bool temporal = false;     // Blend with the previous upscaled frame, clamped to the current one
+};
+
+// Renders a pass that needs no depth into an offscreen target smaller than the window, then scales it
+// up into the window's framebuffer. Adaptive passes time themselves with GPU timer queries and move
+// the scale toward the one whose pixel count fits the frame budget. The target is allocated at window
+// size, so a scale change is only a different viewport.
+class AdaptiveResolution {
+public:
+    int renderWidth = 0, renderHeight = 0; // Size of the current frame's render
+
+    AdaptiveResolution() {};
+    void init(const ResolutionSettings& s); // With the drawing context current
+    void locate();                          // After the upscale program was (re)linked
+    void begin(int width, int height);      // Binds the target at renderWidth x renderHeight
+    void end();                             // Scales the render up into framebuffer 0
+    float scale() const { return current_scale; }
+    ShaderProgram* program() { return &upscale_shader; }
+
+private:
+    void allocate(int width, int height);
+    void readTimers();
+
+    ResolutionSettings settings;
+    ShaderProgram upscale_shader;
+    VAO quad;
+    int width = 0, height = 0;
+    float current_scale = 1.0f;
+
+    GLuint frame_fbo = 0, frame_texture = 0;
+    GLuint history_fbo[2] = {0, 0}, history_texture[2] = {0, 0};
+    int history_index = 0;
+    bool history_valid = false;
+
+    GLuint queries[GPU_TIMER_QUERIES];
+    float query_scale[GPU_TIMER_QUERIES]; // Scale each query timed
+    bool query_issued[GPU_TIMER_QUERIES] = {false};
+    int query_head = 0;
+    float full_ms = 0.0f;                 // Smoothed GPU time of the pass at full resolution
+
+    GLint U_FRAME, U_HISTORY, U_EXTENT, U_TEXEL, U_RESOLUTION, U_SHARPNESS, U_FEEDBACK;
+};
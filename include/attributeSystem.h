@@ -13,6 +13,8 @@
 #define AUDIO_BAND_ATTRIBUTE_OFFSET 1
 #define LINK_ID_MULTIPLIER 10000
 #define VALUE_GENERATOR_ATTRIBUTE_MULTIPLIER 2000
+#define NODE_INPUT_ATTRIBUTE_BASE_ID 1000000
+#define NODE_INPUT_ATTRIBUTE_STRIDE 8
 
 #include "sharedUniforms.h"
 
@@ -43,6 +45,19 @@ namespace AttributeHelpers {
         return VALUE_GENERATOR_ATTRIBUTE_MULTIPLIER + sourceId;
     }
     
+    // Convert a processing node sourceId and input slot to input attribute ID
+    inline int getNodeInputAttributeId(int sourceId, int input) {
+        return NODE_INPUT_ATTRIBUTE_BASE_ID + sourceId * NODE_INPUT_ATTRIBUTE_STRIDE + input;
+    }
+
+    // Convert processing node input attribute ID back to the node sourceId and input slot
+    inline int getNodeFromInputAttributeId(int attributeId) {
+        return (attributeId - NODE_INPUT_ATTRIBUTE_BASE_ID) / NODE_INPUT_ATTRIBUTE_STRIDE;
+    }
+    inline int getInputFromInputAttributeId(int attributeId) {
+        return (attributeId - NODE_INPUT_ATTRIBUTE_BASE_ID) % NODE_INPUT_ATTRIBUTE_STRIDE;
+    }
+
     // Convert audio band attribute ID back to band index
     inline int getBandIndexFromAttributeId(int attributeId) {
         return attributeId / AUDIO_BAND_ATTRIBUTE_MULTIPLIER;
@@ -63,7 +78,13 @@ namespace AttributeHelpers {
     
     // Check if attribute ID is the value generator output
     inline bool isValueGeneratorAttribute(int attributeId) {
-        return attributeId >= VALUE_GENERATOR_ATTRIBUTE_MULTIPLIER; // All value generator outputs are >= 2000
+        return attributeId >= VALUE_GENERATOR_ATTRIBUTE_MULTIPLIER && // All value generator outputs are >= 2000
+               attributeId < NODE_INPUT_ATTRIBUTE_BASE_ID;
+    }
+
+    // Check if attribute ID is a processing node input
+    inline bool isNodeInputAttribute(int attributeId) {
+        return attributeId >= NODE_INPUT_ATTRIBUTE_BASE_ID;
     }
     
     // Check if attribute ID is a valid output (audio band or value generator)
@@ -71,9 +92,9 @@ namespace AttributeHelpers {
         return isAudioBandAttribute(attributeId) || isValueGeneratorAttribute(attributeId);
     }
     
-    // Check if attribute ID is a valid input (parameter)
+    // Check if attribute ID is a valid input (parameter or processing node input)
     inline bool isValidInputAttribute(int attributeId) {
-        return isParameterAttribute(attributeId);
+        return isParameterAttribute(attributeId) || isNodeInputAttribute(attributeId);
     }
     
     // Generate unique link ID
@@ -3,40 +3,126 @@
 #include <array>
 #include <atomic>
 #include <string>
+#include <thread>
+#include <memory>
 #include <cstdio>
+#include <chrono>
 #include "miniaudio/miniaudio.h"
+#include "workerPool.h"
+#include "audioFeatures.h"
+#include "latency.h"
 
 constexpr int SAMPLE_RATE = 48000;
 constexpr int BUFFER_SIZE = 2048;
+constexpr int FILE_HOP    = SAMPLE_RATE / 60; // Samples consumed per offline processFFT() (one 60Hz frame)
+constexpr int FILE_CHUNK  = 256;              // Samples streamed per real-time file tick
+constexpr int MAX_AUDIO_CHANNELS = 8;
+constexpr int IMPULSE_PERIOD = SAMPLE_RATE / 2;  // Samples between clicks in the latency test
+constexpr float IMPULSE_THRESHOLD = 0.5f;        // A lone full-scale click averages 1.0 in every band
 
 ma_device_id select_input_device(ma_context* context);
-
 std::vector<std::string> GetInputDeviceNames(ma_context* context);
 
-struct AudioNest {
+// One analysed signal: a ring buffer filled by a device or file, and its FFT band pipeline.
+struct AudioChannel {
+    std::array<float, BUFFER_SIZE> buffer = {};
+    size_t writeHead = 0;
+    std::atomic<float> bands[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    std::atomic<float> onset{0.0f}; // Spectral flux of the bands since the previous hop
+    float previous[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    // Latency probes: arrival of the newest samples, and when the bands computed from them were ready
+    std::atomic<double> last_write{0.0};
+    double capture_time  = 0.0;
+    double analysis_time = 0.0;
+
+    // Impulse test: the input is replaced by silence with a click every impulse_period samples
+    std::atomic<int> impulse_period{0};
+    int impulse_countdown = 0;
+    std::atomic<double> impulse_time{0.0};
+    std::atomic<bool> impulse_pending{false};
+    unsigned impulses = 0; // Clicks detected by the analysis so far
+
+    void writeSamples(const float* in, ma_uint32 frameCount, int stride = 1);
+    void processFFT();
+};
+
+// A capture device deinterleaving its frames into consecutive channels.
+struct AudioInput {
     ma_device device;
-    ma_context context;
-    static std::array<float, BUFFER_SIZE> g_audioBuffer;
-    std::atomic<float> g_bandAmplitudes[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     int deviceIndex;
-    
-    AudioNest(int index) : deviceIndex(index) {
-        startAudioDevice();
-    };
-    
-    static void data_callback(ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
-        static size_t g_writeHead = 0;
-        const float* in = (const float*)input;        
+    int channelCount;
+    AudioChannel** targets; // channelCount entries, owned by the AudioNest
+    std::atomic<bool> live{true}; // Writes into targets; a replacement waits until the device before it stopped
 
-        for (ma_uint32 i = 0; i < frameCount && g_writeHead < BUFFER_SIZE; ++i) {
-            g_audioBuffer[g_writeHead++] = in[i]; // mono
-        }
-        if (g_writeHead >= BUFFER_SIZE) {
-            g_writeHead = 0;
+    static void data_callback(ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
+        AudioInput* self = (AudioInput*)device->pUserData;
+        if (!self->live.load(std::memory_order_acquire)) return;
+        const float* in = (const float*)input;
+        for (int c = 0; c < self->channelCount; ++c) {
+            self->targets[c]->writeSamples(in + c, frameCount, self->channelCount);
         }
-        
     }
-    void startAudioDevice();
+};
+
+struct AudioInputConfig {
+    int deviceIndex;
+    int channels;
+};
+
+struct AudioNest {
+    ma_context context;
+    ma_decoder decoder;
+    bool context_ready = false;
+    bool decoder_ready = false;
+
+    std::vector<std::unique_ptr<AudioChannel>> channels;
+    std::vector<AudioChannel*> channel_ptrs;
+    std::vector<std::unique_ptr<AudioInput>> inputs;
+    std::atomic<float>* g_bandAmplitudes; // Channel 0, the main mix
+    int deviceIndex;
+    WorkerPool workers;
+
+    // File input: when set, samples come from a decoded WAV/FLAC/MP3 instead of a capture device.
+    // Real-time mode paces the stream on a thread, offline mode advances FILE_HOP samples per processFFT().
+    std::string filePath;
+    bool realtime = true;
+    std::thread file_thread;
+    std::atomic<bool> streaming{false};
+
+    // Feature playback: bands are looked up in a pre-analysed timeline instead of computed live.
+    // With an audio file in real-time mode the file is played out and the timeline follows the played frames.
+    FeatureTimeline features;
+    ma_device playback;
+    bool playing = false;
+    std::atomic<uint64_t> played_frames{0};
+    std::chrono::steady_clock::time_point feature_start;
+
+    // Benchmark counters for the analysis stage
+    double analysis_seconds = 0.0;
+    long   analysis_hops    = 0;
+
+    AudioNest(int index) : AudioNest(std::vector<AudioInputConfig>{{index, 1}}) {};
+    AudioNest(const std::vector<AudioInputConfig>& configs);
+    AudioNest(const std::string& path, bool rt);
+    AudioNest(const std::string& featurePath, const std::string& audioPath, bool rt);
+    ~AudioNest();
+
+    int channelCount() const { return channels.size(); }
     void changeAudioDevice(int index);
+    void changeAudioDevice(int input, int index);
+    void startAudioFile();
+    void startImpulseTest(int period = IMPULSE_PERIOD);
     void processFFT();
-};
\ No newline at end of file
+    uint64_t currentHop() const;
+private:
+    bool openDecoder();
+    void startPlayback();
+    static void playback_callback(ma_device* device, void* output, const void* input, ma_uint32 frameCount);
+    void initContext();
+    void allocateChannels(int count);
+    std::unique_ptr<AudioInput> openInput(int index, int firstChannel, int count, bool live = true);
+    void closeInput(AudioInput& input);
+    void streamFile();
+    void readFileSamples(ma_uint32 frameCount);
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Pre-analysed band features written by ./analyze and memory-mapped at playback.
+// Layout: FeatureHeader, then hops x stems x stride floats (4 bands followed by the onset strength).
+constexpr uint32_t FEATURE_MAGIC   = 0x5446574F; // "OWFT"
+constexpr uint32_t FEATURE_VERSION = 1;
+constexpr uint32_t FEATURE_STRIDE  = 5;
+
+struct FeatureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t stems;
+    uint32_t stride;
+    uint32_t hop;        // Samples between consecutive frames
+    uint32_t sampleRate;
+    uint64_t hops;
+};
+
+struct FeatureTimeline {
+    const FeatureHeader* header = nullptr;
+    const float* frames = nullptr;
+    size_t mapped_size = 0;
+
+    FeatureTimeline() = default;
+    FeatureTimeline(const FeatureTimeline&) = delete;
+    FeatureTimeline& operator=(const FeatureTimeline&) = delete;
+    ~FeatureTimeline() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+    bool loaded() const { return header != nullptr; }
+    int stems() const { return header ? header->stems : 0; }
+
+    // Features of one stem at a hop; hops past the end wrap, matching looped playback.
+    const float* frame(uint64_t hop, int stem) const {
+        return frames + ((hop % header->hops) * header->stems + stem) * header->stride;
+    }
+};
+
+bool writeFeatureFile(const std::string& path, uint32_t stems, uint32_t hop, const std::vector<float>& frames);
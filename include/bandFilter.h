@@ -0,0 +1,62 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+
+#define AGC_FLOOR    1e-5f  // Loudness below this is treated as silence, not boosted further
+#define AGC_MAX_GAIN 1000.0f
+
+// Four bands as one SIMD vector (SSE on x86, NEON on ARM) via the GCC/Clang vector extension.
+typedef float band_vec __attribute__((vector_size(16)));
+typedef int   band_mask __attribute__((vector_size(16)));
+
+struct BandFilterParams {
+    float attack;     // Envelope rise time, seconds
+    float release;    // Envelope fall time, seconds
+    float smoothing;  // 0 = none, towards 1 = heavier exponential smoothing of the envelope
+    float agc_amount; // 0 = fixed gain, 1 = long-term loudness fully normalised
+    float agc_target; // Level the AGC brings the bands to
+    float agc_time;   // Seconds of history behind the loudness estimate
+};
+
+// Per-band attack/release envelope follower, smoothing and automatic gain control.
+// All bands run through the same straight-line vector code; per-band choices are mask blends.
+struct BandFilter {
+    band_vec envelope = {0.0f, 0.0f, 0.0f, 0.0f};
+    band_vec smoothed = {0.0f, 0.0f, 0.0f, 0.0f};
+    band_vec loudness = {0.0f, 0.0f, 0.0f, 0.0f};
+    bool primed = false;
+
+    void process(const float* in, float* out, const BandFilterParams& p, float dt) {
+        band_vec x = {in[0], in[1], in[2], in[3]};
+        if (!primed) {
+            // Start the AGC at the current level instead of ramping up from silence
+            envelope = smoothed = loudness = max(x, splat(AGC_FLOOR));
+            primed = true;
+        }
+        dt = std::max(dt, 0.0f);
+
+        band_vec attack  = splat(coefficient(dt, p.attack));
+        band_vec release = splat(coefficient(dt, p.release));
+        envelope += blend(x > envelope, attack, release) * (x - envelope);
+
+        smoothed += splat(1.0f - std::min(std::max(p.smoothing, 0.0f), 0.99f)) * (envelope - smoothed);
+
+        loudness += splat(coefficient(dt, p.agc_time)) * (smoothed - loudness);
+        band_vec gain = min(splat(p.agc_target) / max(loudness, splat(AGC_FLOOR)), splat(AGC_MAX_GAIN));
+        gain = splat(1.0f) + splat(p.agc_amount) * (gain - splat(1.0f));
+
+        band_vec y = smoothed * gain;
+        for (int i = 0; i < 4; ++i) out[i] = y[i];
+    }
+private:
+    // One-pole coefficient reaching ~63% of a step after `seconds`
+    static float coefficient(float dt, float seconds) {
+        return 1.0f - std::exp(-dt / std::max(seconds, 1e-4f));
+    }
+    static band_vec splat(float v) { return band_vec{v, v, v, v}; }
+    static band_vec blend(band_mask mask, band_vec a, band_vec b) {
+        return (band_vec)((mask & (band_mask)a) | (~mask & (band_mask)b));
+    }
+    static band_vec min(band_vec a, band_vec b) { return blend(a < b, a, b); }
+    static band_vec max(band_vec a, band_vec b) { return blend(a > b, a, b); }
+};
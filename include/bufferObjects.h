@@ -55,9 +55,11 @@ public:
 	GLsizeiptr size;
 	
 	UBO();
-	UBO(GLfloat* vertices, GLsizeiptr size);
+	UBO(GLfloat* vertices, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW);
 
 	void Bind();
+	void BindBase(GLuint binding);
+	void Update(const void* data, GLsizeiptr size);
 	void Unbind();
 	void Delete();
 };
@@ -76,6 +78,7 @@ public:
 		GLuint* indices, GLsizeiptr indicesSize);
 	VAO(GLfloat* vertices, GLsizeiptr verticesSize, GLfloat* colors, GLsizeiptr colorsSize);
 	VAO(GLfloat* vertices, GLsizeiptr verticesSize);
+	VAO(const VBO& shared_vbo, const EBO& shared_ebo); // Buffers of another context in the share group
 	void NewIndeces(GLuint* indeces, GLsizeiptr indecesSize);
 	void LinkVecs(std::vector<int> pattern, int total);
 	void LinkVecs(std::vector<int> pattern);
@@ -1,8 +1,31 @@
+#include <string>
+#include <vector>
+#include <utility>
+
 struct CLAs {
     bool fullscreen     = false;
     int monitorIndex    = 0;
     int audioIndex      = 0;
     std::string shaderPath = "";
+    std::string audioFile  = "";    // Analyse a WAV/FLAC/MP3 instead of a capture device
+    std::string featureFile = "";   // Play back bands pre-analysed by ./analyze (audio file, if any, is played out)
+    bool offline        = false;    // Fixed timestep, no vsync, audio advanced per frame
+    int benchFrames     = 0;        // Exit after this many frames and report timings (0 = run forever)
+    bool impulseTest    = false;    // Replace the input with periodic clicks and measure their latency
+    std::string group   = "default"; // Instance group: select and its renderers share one parameter set
+    bool onChange       = false;    // Renderer only redraws when select publishes a change
+    std::string recordFile = "";    // select: write every published parameter change here
+    std::string replayFile = "";    // Renderer: take parameters from a recording instead of select
+    float renderScale   = 0.0f;     // fragment: render at this fraction of the window and upscale
+    float targetFps     = 0.0f;     // fragment: adapt the render scale to hold this frame rate
+    bool sharpen        = false;    // Upscale with a sharpening filter instead of plain bilinear
+    bool temporal       = false;    // Blend upscaled frames with the previous one
+    float webDetail     = 40.0f;    // spin: cells smaller than this many pixels draw plain pentagons (0 = never)
+    bool depthPrepass   = false;    // game: lay down the walls' depth before shading a spell over them
+
+    // Frame n renders time n / OFFLINE_FPS: benchmarks and replays are reproducible
+    bool fixedStep() const { return offline || !replayFile.empty(); }
+    std::vector<std::pair<int, int>> inputs; // --inputs 0:2,3:1 -> (device, channels) captured together
 };
 
 CLAs parse(int argc, char** argv);
@@ -12,16 +12,19 @@ struct CameraInfo
     glm::mat4 View;
     glm::mat4 Model;
     glm::vec3 Location;
+    glm::mat4 Spin;         // accountSpin's accumulated rotation, per camera so outputs can spin apart
+    bool spinning = false;
 };
 
-GLFWwindow* initializeWindow(unsigned int start_width, unsigned int start_height, const char* title, bool fullscreen, int monitorIndex);
+GLFWwindow* initializeWindow(unsigned int start_width, unsigned int start_height, const char* title, bool fullscreen, int monitorIndex,
+                             GLFWwindow* share = nullptr);
 GLFWwindow* initializeWindow(unsigned int start_width, unsigned int start_height, const char* title);
 
 void accountCameraControls(Uniforms* uniforms, CameraInfo& camera_mats);
 void accountSpin(Uniforms* uniforms, CameraInfo& camera_mats);
 void accountSpin(Uniforms* uniforms, CameraInfo& camera_mats, float scale, float warp, float scroll);
 
-GLuint getSpellSubroutine(Uniforms* uniforms, Grimoire& grimoire, GLuint shader_id);
+SpellEffect getSpellEffect(Uniforms* uniforms, Grimoire& grimoire);
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void resizeCallback(GLFWwindow* window, int width, int height);
 void mouseCallback(GLFWwindow* window, double xpos, double ypos);
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#define GENERATOR_MODES 6 // NodeFactory::NodeType: Sinusoid, Square, Triangle, Sawtooth, Noise, Constant
+#define GENERATOR_LANES 4 // Generators advanced per vector step
+
+struct GeneratorSettings {
+    float frequency, amplitude, phase, dutyCycle, speed, constantValue;
+};
+
+// A periodic generator as the bank last left it, so the graph executor can evaluate it between updates
+struct GeneratorWave {
+    int load;    // Executor load the generator feeds
+    int mode;
+    float cycle; // At the end of the hop
+    float frequency, amplitude, phase, duty;
+    float at(float c) const; // Output at cycle c
+};
+
+// All generators of one mode as structure-of-arrays, padded to whole vectors. Lane i writes its
+// output to targets[i], and keeps *slots[i] == i as lanes are swapped around on removal.
+struct GeneratorLanes {
+    int count = 0;
+    std::vector<float> cycle, frequency, amplitude, phase, duty, speed, constant, walk, out;
+    std::vector<uint32_t> seed;
+    std::vector<float*> targets;
+    std::vector<int*> slots;
+};
+
+// Advances every value generator of a patch in one pass per mode, with no per-node dispatch.
+// Generators keep their settings for the UI and JSON and mirror them here on every change.
+class GeneratorBank {
+public:
+    void add(int mode, const GeneratorSettings& s, float* target, int* slot, float cycle = 0.0f);
+    void remove(int mode, int slot);
+    void set(int mode, int slot, const GeneratorSettings& s);
+    void move(int from, int slot, int to); // Mode change, keeping the phase
+    void update(float dt);
+    bool wave(int mode, int slot, GeneratorWave& w) const; // False for noise and constants
+    int size() const;
+private:
+    GeneratorLanes lanes[GENERATOR_MODES];
+    uint32_t next_seed = 0x9E3779B9u;
+};
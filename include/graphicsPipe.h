@@ -1,3 +1,4 @@
+#pragma once
 #include "config.h"
 #include "gameWindow.h"
 #include "shaderClass.h"
@@ -8,6 +9,35 @@
 #include "debug.h"
 #include "cla.h"
 #include "sharedUniforms.h"
+#include "audio.h"
+#include "paramRecorder.h"
+#include "shaderWatcher.h"
+#include "adaptiveResolution.h"
+#include <atomic>
+
+#define OFFLINE_FPS 60.0f // Fixed timestep used by --offline runs
+#define PARAMS_BINDING 1  // Uniform buffer binding of ShowParams (CameraMatrices uses 0)
+#define FRAME_BINDING  3  // Uniform buffer binding of SpinFrame (Materials uses 2)
+#define ON_CHANGE_WAIT_MS 250 // --on-change: longest wait before handling window events anyway
+
+// std140 mirror of the ShowParams block in shaders/params.glsl
+struct ShowParams {
+    float audio_bands[BAND_COUNT];
+    float scale, brightness, speed, fov;
+    float hueShift, vignette, linePx, lineFade;
+    float shatter, pad[3];
+    ShowParams(const UniformStructure& u);
+};
+static_assert(sizeof(ShowParams) == 64, "ShowParams must match the std140 layout of params.glsl");
+
+// std140 mirror of the SpinFrame block in shaders/frame.glsl
+struct SpinFrame {
+    float resolution[2], mouse[2];
+    float scroll, time, pad[2];
+};
+static_assert(sizeof(SpinFrame) == 32, "SpinFrame must match the std140 layout of frame.glsl");
+
+struct SharedAssets; // rendererHost.h
 
 enum PipeType {
     GAME,
@@ -19,28 +49,49 @@ struct ShaderInterface {
     CLAs clas;
     Uniforms* window_uniforms;
     CameraInfo cam;
+    AudioNest* audio_nest = nullptr; // Local analysis when --audio-file is given
+    LatencyStats latency;            // Impulse latencies seen by this renderer (see --impulse-test)
+    UBO params_ubo;                  // ShowParams, one upload per published change
+    ParamPlayer replay;              // --replay recording, replaces select
     ShaderInterface(CLAs c, Uniforms* w) : 
         clas(c), window_uniforms(w) {};
-    virtual ~ShaderInterface() = default;
+    virtual ~ShaderInterface() { delete audio_nest; };
     virtual void compile() = 0;
+    virtual void locate() {};  // Uniforms and blocks of freshly linked programs
+    virtual std::vector<ShaderProgram*> watchedPrograms() { return {}; }; // Reloaded when their files change
     virtual void render() = 0;
+    virtual void waitForChange(int timeout_ms) {}; // Blocks until the shared parameters change
+
+    void openReplay();
+    bool pullParams(SharedUniforms& shared, float time); // True when the parameters changed
+    void initParams();
+    bool attachParams(GLuint program); // False when the program does not declare ShowParams
+    void uploadParams(const UniformStructure& u);
+};
+
+// Uniforms of the world program, located once per SpellEffect variant
+enum WorldUniform {
+    W_RESOLUTION, W_MOUSE, W_SCROLL, W_TIME,
+    W_CAST_LIFE, W_SPELL_LIFE, W_SPELL_FOCUS, W_SPELL_HEAD,
+    WORLD_UNIFORMS
 };
 
 struct GamePatterns : public ShaderInterface {
-    ShaderProgram world_shader, fx_shader, gui_shader;
+    ShaderVariants world_shaders; // Indexed by SpellEffect
+    ShaderProgram fx_shader, gui_shader;
+    ShaderProgram depth_shader;   // The world's walls without shading, for --depth-prepass
     PlayerContext player_context;
     TextureLibrary texture_library;
     Grimoire grimoire;
 
-    GLuint  U_RESOLUTION, U_MOUSE, U_SCROLL, U_TIME,
-            U_SPELL_LIFE, U_CAST_LIFE, U_SPELL_FOCUS, U_SPELL_HEAD,
-            U_FLIP_PROGRESS, U_TIME_BOOK;
+    GLuint  U_FLIP_PROGRESS, U_TIME_BOOK;
     GLuint  S_SPELL_LIFE;
-    GLuint subroutine_index;
     GLuint U_GLOBAL;
 
     GamePatterns(CLAs c, Uniforms* w);
     void compile() override;
+    void locate() override;
+    std::vector<ShaderProgram*> watchedPrograms() override;
     void render() override;
 };
 
@@ -48,14 +99,19 @@ struct SpinPatterns : public ShaderInterface {
     ShaderProgram spin_shader;
     PlayerContext player_context;
     
-    GLuint U_RESOLUTION, U_MOUSE, U_SCROLL, U_TIME, U_BANDS, U_SCALE, 
-        U_BRIGHTNESS, U_HUESHIFT, U_VIGNETTE, U_LINE_PX, U_LINE_FADE, U_SHATTER;
     GLuint U_GLOBAL;
+    UBO frame_ubo; // SpinFrame, this output's own
     SharedUniforms shared_uniforms = SharedUniforms(false);
+    SharedAssets* assets = nullptr; // Program and map shared with the host's other outputs
+    unsigned program_generation = 0;
 
-    SpinPatterns(CLAs c, Uniforms* w);
+    SpinPatterns(CLAs c, Uniforms* w, SharedAssets* a = nullptr);
     void compile() override;
+    void locate() override;
+    std::vector<ShaderProgram*> watchedPrograms() override;
+    void adoptShared(); // program_lock held
     void render() override;
+    void waitForChange(int timeout_ms) override;
 };
 
 struct FragPatterns : public ShaderInterface {
@@ -65,10 +121,17 @@ struct FragPatterns : public ShaderInterface {
     GLuint  U_RESOLUTION, U_MOUSE, U_SCROLL, U_TIME,
             U_SCALE, U_BRIGHTNESS, U_SPEED, U_FOV, U_HUESHIFT, U_AUDIO_BANDS;
     SharedUniforms shared_uniforms = SharedUniforms(false);
+    bool params_in_block = false; // Shader includes sharedUniforms.glsl; older ones declare plain uniforms
+    bool reupload = true;         // Freshly linked program, its plain uniforms still hold defaults
+    AdaptiveResolution resolution;
+    bool scaled = false;          // --render-scale or --target-fps: drawn below window resolution
 
     FragPatterns(CLAs c, Uniforms* w);
     void compile() override;
+    void locate() override;
+    std::vector<ShaderProgram*> watchedPrograms() override;
     void render() override;
+    void waitForChange(int timeout_ms) override;
 };
 
 struct GraphicsPipe {
@@ -76,16 +139,26 @@ struct GraphicsPipe {
     Uniforms* window_uniforms;
     ShaderInterface* shader_interface;
     
-    static float time, previousTime;
-    static int frameCount;
+    float time = 0.0f, previousTime = 0.0f;
+    int frameCount = 0;
+    std::atomic<int> fps{0};
+    int renderedFrames = 0;
+    double benchStart = 0.0;
     PipeType type;
     const char* window_name;
     GLFWwindow* window;
+    SharedAssets* assets = nullptr; // Set when a RendererHost runs this pipe on its own thread
+    ShaderWatcher* watcher = nullptr;
+    bool compiled = false;
 
     GraphicsPipe(PipeType t, CLAs c) : type(t), clas(c) {};
     ~GraphicsPipe();
     void initHere(GLFWwindow* w);
+    void initHosted(GLFWwindow* w, SharedAssets* a); // Called on the render thread, w current
     void initWindowed();
+    void watchShaders(); // Main thread, window current
     void establishShaders();
     void renderNextFrame(bool swapBuffers = true);
+    bool benchmarkComplete();
+    void waitForChange();
 };
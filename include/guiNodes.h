@@ -2,12 +2,17 @@
 #define GUI_NODES_H
 
 #include <cmath>
+#include <cstring>
 #include <string>
 #include <functional>
 #include <imgui.h>
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <nlohmann/json.hpp>
+#include "modulationGraph.h"
+#include "generatorBank.h"
+#include "presetFormat.h"
 
 // Forward declaration
 struct UniformMeta;
@@ -34,10 +39,14 @@ public:
     // Optional interface for sources that can be configured
     virtual bool hasConfigurableParameters() const { return false; }
     virtual void setValue(float newValue) { value = newValue; }
+
+    // Audio sources carry positive amplitudes rather than zero-mean waves
+    virtual bool isAudio() const { return sourceId < BAND_COUNT; }
+    virtual int getBandIndex() const { return -1; }
     
     // Get processed value that would be applied to parameters (with centering/scaling)
     virtual float getProcessedValue(const UniformMeta& um) const { 
-        if (sourceId < BAND_COUNT) {
+        if (isAudio()) {
             // Audio band: positive values, map directly to parameter range
             return um.min + std::min(value / 2.0f, 1.0f) * (um.max - um.min);
         } else {
@@ -51,7 +60,7 @@ public:
     
     // Get normalized value for visual feedback (0-1 range)
     virtual float getNormalizedValue() const {
-        if (sourceId < BAND_COUNT) {
+        if (isAudio()) {
             return std::min(value, 1.0f);
         } else {
             // Value generator: normalize to 0-1 (simple approach)
@@ -66,19 +75,30 @@ public:
 
     virtual nlohmann::json to_json() const { return {}; }
     virtual void from_json(const nlohmann::json& j) {}
+    // Binary preset counterparts of to_json/from_json
+    virtual void to_record(PresetSource& r) const {}
+    virtual void from_record(const PresetSource& r) {}
+
+    // Where update() leaves the current value, read directly by the compiled modulation program
+    const float* valueSlot() const { return &value; }
+    // True once after settings that are compiled into the program were changed in the UI
+    bool consumeEdit() { bool e = edited; edited = false; return e; }
+protected:
+    bool edited = false;
 };
 
-// Audio band as a value source
+// Audio band as a value source, either from the main mix (channel 0) or a separate input channel
 class AudioBandSource : public ValueSource {
 private:
     int bandIndex;
+    int channel;
     float* audioData;
     float volume = 1.0f;
     
 public:
-    AudioBandSource(int bandIdx, float* audioPtr) 
-        : ValueSource("Band " + std::to_string(bandIdx), bandIdx), 
-          bandIndex(bandIdx), audioData(audioPtr) {}
+    AudioBandSource(int bandIdx, float* audioPtr, int ch = 0) 
+        : ValueSource((ch ? "Ch " + std::to_string(ch) + " " : std::string()) + "Band " + std::to_string(bandIdx), bandIdx), 
+          bandIndex(bandIdx), channel(ch), audioData(audioPtr) {}
     
     void update(float deltaTime) override {
         // Audio bands are updated externally via FFT
@@ -88,7 +108,9 @@ public:
     void renderUI() override {}
     
     bool hasConfigurableParameters() const override { return true; }
-    int getBandIndex() const { return bandIndex; }
+    bool isAudio() const override { return true; }
+    int getBandIndex() const override { return bandIndex; }
+    int getChannel() const { return channel; }
     float getVolume() const { return volume; }
     
     // Override to sync with shared uniforms
@@ -104,7 +126,9 @@ public:
     }
 
     int getOutputAttributeId() const override {
-        return AttributeHelpers::getAudioBandAttributeId(bandIndex);
+        // Extra channels are addressed by sourceId like generators, the main mix keeps its band attributes
+        return channel ? AttributeHelpers::getValueGeneratorAttributeId(sourceId)
+                       : AttributeHelpers::getAudioBandAttributeId(bandIndex);
     }
 
     nlohmann::json to_json() const override {
@@ -112,6 +136,7 @@ public:
             {"type", "audio_band"},
             {"sourceId", sourceId},
             {"bandIndex", bandIndex},
+            {"channel", channel},
             {"volume", volume}
         };
     }
@@ -119,6 +144,13 @@ public:
         // audioData pointer must be set externally after construction
         if (j.contains("volume")) volume = j["volume"].get<float>();
     }
+    void to_record(PresetSource& r) const override {
+        r.type = PRESET_AUDIO_BAND;
+        r.a = bandIndex;
+        r.b = channel;
+        r.values[0] = volume;
+    }
+    void from_record(const PresetSource& r) override { volume = r.values[0]; }
 };
 
 // Node factory for creating different types of value generators
@@ -146,72 +178,47 @@ public:
     }
 };
 
-// Unified multi-mode value generator that can switch between different wave types
+// Unified multi-mode value generator that can switch between different wave types.
+// The settings live here for the UI and JSON; once added to a manager the generator is a lane of its
+// GeneratorBank, which advances it together with every other generator of the same mode.
 class MultiModeValueGenerator : public ValueSource {
 private:
-    float time = 0.0f;
     float frequency = 0.1f;
     float amplitude = 1.0f;
     float phase = 0.0f;
     float dutyCycle = 0.5f;
     float speed = 1.0f;
-    float lastValue = 0.0f;
     float constantValue = 0.5f;
     
     NodeFactory::NodeType currentMode = NodeFactory::NodeType::Sinusoid;
     int selectedMode = 0; // Instance-specific mode selection for UI
+
+    GeneratorBank* bank = nullptr;
+    int slot = -1; // Lane within the bank's lanes for currentMode, kept current by the bank
+
+    GeneratorSettings settings() const {
+        return {frequency, amplitude, phase, dutyCycle, speed, constantValue};
+    }
+    // Mirror the settings into the bank after a change
+    void push() { if (bank) bank->set((int)currentMode, slot, settings()); }
     
 public:
     MultiModeValueGenerator() : ValueSource("Value Generator", 0) {} // ID will be set by manager
-    
-    void update(float deltaTime) override {
-        time += deltaTime;
-        
-        switch (currentMode) {
-            case NodeFactory::NodeType::Sinusoid:
-                value = amplitude * sin(2.0f * M_PI * frequency * time + phase);
-                break;
-                
-            case NodeFactory::NodeType::Square:
-                {
-                    float cycle = fmod(frequency * time, 1.0f);
-                    value = (cycle < dutyCycle) ? amplitude : -amplitude;
-                }
-                break;
-                
-            case NodeFactory::NodeType::Triangle:
-                {
-                    float cycle = fmod(frequency * time, 1.0f);
-                    if (cycle < 0.5f) {
-                        value = amplitude * (4.0f * cycle - 1.0f);
-                    } else {
-                        value = amplitude * (3.0f - 4.0f * cycle);
-                    }
-                }
-                break;
-                
-            case NodeFactory::NodeType::Sawtooth:
-                {
-                    float cycle = fmod(frequency * time, 1.0f);
-                    value = amplitude * (2.0f * cycle - 1.0f);
-                }
-                break;
-                
-            case NodeFactory::NodeType::Noise:
-                {
-                    // Simple random walk implementation
-                    float change = (static_cast<float>(rand()) / RAND_MAX - 0.5f) * 2.0f * speed * deltaTime;
-                    lastValue += change;
-                    lastValue = std::max(-amplitude, std::min(amplitude, lastValue));
-                    value = lastValue;
-                }
-                break;
-                
-            case NodeFactory::NodeType::Constant:
-                value = constantValue;
-                break;
-        }
+    ~MultiModeValueGenerator() override { detach(); }
+
+    void attach(GeneratorBank* b) {
+        detach();
+        bank = b;
+        bank->add((int)currentMode, settings(), &value, &slot);
     }
+    void detach() {
+        if (bank) bank->remove((int)currentMode, slot);
+        bank = nullptr;
+    }
+    
+    // Advanced by the bank
+    void update(float deltaTime) override {}
+    bool wave(GeneratorWave& w) const { return bank && bank->wave((int)currentMode, slot, w); }
     
     void renderUI() override {
         // Mode selection dropdown
@@ -225,10 +232,7 @@ public:
             for (int i = 0; i < 6; ++i) {
                 bool is_selected = (selectedMode == i);
                 if (ImGui::Selectable(modes[i], is_selected)) {
-                    if (selectedMode != i) {
-                        selectedMode = i;
-                        currentMode = static_cast<NodeFactory::NodeType>(i);
-                    }
+                    if (selectedMode != i) setMode(static_cast<NodeFactory::NodeType>(i));
                 }
                 if (is_selected) ImGui::SetItemDefaultFocus();
             }
@@ -236,36 +240,38 @@ public:
         }
         
         // Common parameters
+        bool changed = false;
         ImGui::SetNextItemWidth(100.0f);
-        ImGui::SliderFloat("Freq", &frequency, 0.01f, 0.1f, "%.2f");
+        changed |= ImGui::SliderFloat("Freq", &frequency, 0.01f, 0.1f, "%.2f");
         ImGui::SetNextItemWidth(100.0f);
-        ImGui::SliderFloat("Amp", &amplitude, 0.1f, 5.0f, "%.2f");
+        changed |= ImGui::SliderFloat("Amp", &amplitude, 0.1f, 5.0f, "%.2f");
         
         // Mode-specific parameters
         switch (currentMode) {
             case NodeFactory::NodeType::Sinusoid:
                 ImGui::SetNextItemWidth(100.0f);
-                ImGui::SliderFloat("Phase", &phase, -M_PI, M_PI, "%.2f");
+                changed |= ImGui::SliderFloat("Phase", &phase, -M_PI, M_PI, "%.2f");
                 break;
                 
             case NodeFactory::NodeType::Square:
                 ImGui::SetNextItemWidth(100.0f);
-                ImGui::SliderFloat("Duty", &dutyCycle, 0.0f, 1.0f, "%.2f");
+                changed |= ImGui::SliderFloat("Duty", &dutyCycle, 0.0f, 1.0f, "%.2f");
                 break;
                 
             case NodeFactory::NodeType::Noise:
                 ImGui::SetNextItemWidth(100.0f);
-                ImGui::SliderFloat("Speed", &speed, 0.1f, 10.0f, "%.1f");
+                changed |= ImGui::SliderFloat("Speed", &speed, 0.1f, 10.0f, "%.1f");
                 break;
                 
             case NodeFactory::NodeType::Constant:
                 ImGui::SetNextItemWidth(100.0f);
-                ImGui::SliderFloat("Value", &constantValue, -2.0f, 2.0f, "%.2f");
+                changed |= ImGui::SliderFloat("Value", &constantValue, -2.0f, 2.0f, "%.2f");
                 break;
                 
             default:
                 break;
         }
+        if (changed) push();
         
         ImGui::Text("Value: %.3f", value);
     }
@@ -273,27 +279,28 @@ public:
     // Getters and setters
     NodeFactory::NodeType getCurrentMode() const { return currentMode; }
     void setMode(NodeFactory::NodeType mode) { 
+        if (bank && mode != currentMode) bank->move((int)currentMode, slot, (int)mode);
         currentMode = mode; 
         selectedMode = static_cast<int>(mode);
     }
     
     float getFrequency() const { return frequency; }
-    void setFrequency(float freq) { frequency = freq; }
+    void setFrequency(float freq) { frequency = freq; push(); }
     
     float getAmplitude() const { return amplitude; }
-    void setAmplitude(float amp) { amplitude = amp; }
+    void setAmplitude(float amp) { amplitude = amp; push(); }
     
     float getPhase() const { return phase; }
-    void setPhase(float p) { phase = p; }
+    void setPhase(float p) { phase = p; push(); }
     
     float getDutyCycle() const { return dutyCycle; }
-    void setDutyCycle(float duty) { dutyCycle = std::max(0.0f, std::min(1.0f, duty)); }
+    void setDutyCycle(float duty) { dutyCycle = std::max(0.0f, std::min(1.0f, duty)); push(); }
     
     float getSpeed() const { return speed; }
-    void setSpeed(float s) { speed = s; }
+    void setSpeed(float s) { speed = s; push(); }
     
     float getConstantValue() const { return constantValue; }
-    void setConstantValue(float val) { constantValue = val; }
+    void setConstantValue(float val) { constantValue = val; push(); }
 
     int getOutputAttributeId() const override {
         return AttributeHelpers::getValueGeneratorAttributeId(sourceId);
@@ -320,15 +327,318 @@ public:
         if (j.contains("dutyCycle")) dutyCycle = j["dutyCycle"].get<float>();
         if (j.contains("speed")) speed = j["speed"].get<float>();
         if (j.contains("constantValue")) constantValue = j["constantValue"].get<float>();
+        push();
+    }
+    void to_record(PresetSource& r) const override {
+        r.type = PRESET_GENERATOR;
+        r.a = (int)currentMode;
+        GeneratorSettings s = settings();
+        memcpy(r.values, &s, sizeof(s));
+    }
+    void from_record(const PresetSource& r) override {
+        setMode((NodeFactory::NodeType)r.a);
+        GeneratorSettings s;
+        memcpy(&s, r.values, sizeof(s));
+        frequency = s.frequency;
+        amplitude = s.amplitude;
+        phase = s.phase;
+        dutyCycle = s.dutyCycle;
+        speed = s.speed;
+        constantValue = s.constantValue;
+        push();
+    }
+};
+
+// Intermediate patch node: combines or shapes its inputs. Only settings live here, the node itself is
+// evaluated by the GraphExecutor, which writes its latest output back for display.
+class ProcessingNode : public ValueSource {
+private:
+    ModulationKind kind;
+    int inputs[MAX_NODE_INPUTS] = {-1, -1, -1, -1}; // Source ids, -1 when unconnected
+    float k[4];
+
+public:
+    ProcessingNode(ModulationKind nodeKind) : ValueSource(getKindName(nodeKind), 0), kind(nodeKind) {
+        switch (kind) {
+            case ModulationKind::Clamp:      k[0] = 0.0f;  k[1] = 1.0f;  k[2] = 0.0f; k[3] = 0.0f; break;
+            case ModulationKind::MapRange:   k[0] = 0.0f;  k[1] = 1.0f;  k[2] = 0.0f; k[3] = 2.0f; break;
+            case ModulationKind::Slew:       k[0] = 2.0f;  k[1] = 0.5f;  k[2] = 0.0f; k[3] = 0.0f; break;
+            case ModulationKind::SampleHold: k[0] = 0.5f;  k[1] = 0.0f;  k[2] = 0.0f; k[3] = 0.0f; break;
+            case ModulationKind::Lfo:        k[0] = 0.5f;  k[1] = 0.0f;  k[2] = 1.0f; k[3] = 0.0f; break;
+            default:                         k[0] = 0.0f;  k[1] = 0.0f;  k[2] = 0.0f; k[3] = 0.0f; break;
+        }
+    }
+
+    static const char* getKindName(ModulationKind kind) {
+        switch (kind) {
+            case ModulationKind::Add: return "Add";
+            case ModulationKind::Multiply: return "Multiply";
+            case ModulationKind::Clamp: return "Clamp";
+            case ModulationKind::MapRange: return "Map Range";
+            case ModulationKind::Slew: return "Slew";
+            case ModulationKind::SampleHold: return "Sample & Hold";
+            case ModulationKind::Lfo: return "LFO";
+            default: return "Unknown";
+        }
+    }
+
+    int getInputCount() const {
+        switch (kind) {
+            case ModulationKind::Add:
+            case ModulationKind::Multiply: return 4;
+            case ModulationKind::SampleHold:
+            case ModulationKind::Lfo: return 2;
+            default: return 1;
+        }
+    }
+
+    const char* getInputName(int input) const {
+        switch (kind) {
+            case ModulationKind::SampleHold: return input ? "Trigger" : "In";
+            case ModulationKind::Lfo: return input ? "Rate" : "Sync";
+            default: return "In";
+        }
+    }
+
+    // Register an unconnected input reads: the identity of the operation
+    int getInputDefault() const { return kind == ModulationKind::Multiply ? REGISTER_ONE : REGISTER_ZERO; }
+
+    void update(float deltaTime) override {}
+
+    void renderUI() override {
+        ImGui::Text("%s", getKindName(kind));
+        bool changed = false;
+        ImGui::PushItemWidth(100.0f);
+        switch (kind) {
+            case ModulationKind::Clamp:
+                changed |= ImGui::SliderFloat("Min", &k[0], -2.0f, 2.0f, "%.2f");
+                changed |= ImGui::SliderFloat("Max", &k[1], -2.0f, 2.0f, "%.2f");
+                break;
+            case ModulationKind::MapRange:
+                changed |= ImGui::SliderFloat("In Min", &k[0], -2.0f, 2.0f, "%.2f");
+                changed |= ImGui::SliderFloat("In Max", &k[1], -2.0f, 2.0f, "%.2f");
+                changed |= ImGui::SliderFloat("Out Min", &k[2], -2.0f, 2.0f, "%.2f");
+                changed |= ImGui::SliderFloat("Out Max", &k[3], -2.0f, 2.0f, "%.2f");
+                break;
+            case ModulationKind::Slew:
+                changed |= ImGui::SliderFloat("Rise", &k[0], 0.0f, 20.0f, "%.2f /s");
+                changed |= ImGui::SliderFloat("Fall", &k[1], 0.0f, 20.0f, "%.2f /s");
+                break;
+            case ModulationKind::SampleHold:
+                changed |= ImGui::SliderFloat("Threshold", &k[0], 0.0f, 2.0f, "%.2f");
+                break;
+            case ModulationKind::Lfo: {
+                const char* shapes[] = {"Sinusoid", "Triangle", "Sawtooth", "Square"};
+                int shape = (int)k[1];
+                changed |= ImGui::SliderFloat("Freq", &k[0], 0.01f, 10.0f, "%.2f Hz");
+                if (ImGui::Combo("Shape", &shape, shapes, 4)) {
+                    k[1] = (float)shape;
+                    changed = true;
+                }
+                changed |= ImGui::SliderFloat("Amp", &k[2], 0.1f, 5.0f, "%.2f");
+                break;
+            }
+            default:
+                break;
+        }
+        ImGui::PopItemWidth();
+        edited |= changed;
+        ImGui::Text("Value: %.3f", value);
+    }
+
+    ModulationKind getKind() const { return kind; }
+    const float* getConstants() const { return k; }
+    int getInput(int input) const { return inputs[input]; }
+    void setInput(int input, int id) { inputs[input] = id; }
+
+    int getInputAttributeId(int input) const {
+        return AttributeHelpers::getNodeInputAttributeId(sourceId, input);
+    }
+
+    int getOutputAttributeId() const override {
+        return AttributeHelpers::getValueGeneratorAttributeId(sourceId);
+    }
+
+    nlohmann::json to_json() const override {
+        return {
+            {"type", "processor"},
+            {"sourceId", sourceId},
+            {"kind", (int)kind},
+            {"inputs", std::vector<int>(inputs, inputs + MAX_NODE_INPUTS)},
+            {"constants", std::vector<float>(k, k + 4)}
+        };
+    }
+    void from_json(const nlohmann::json& j) override {
+        if (j.contains("inputs")) {
+            std::vector<int> in = j["inputs"].get<std::vector<int>>();
+            for (int i = 0; i < MAX_NODE_INPUTS && i < (int)in.size(); ++i) inputs[i] = in[i];
+        }
+        if (j.contains("constants")) {
+            std::vector<float> c = j["constants"].get<std::vector<float>>();
+            for (int i = 0; i < 4 && i < (int)c.size(); ++i) k[i] = c[i];
+        }
+    }
+    void to_record(PresetSource& r) const override {
+        r.type = PRESET_PROCESSOR;
+        r.a = (int)kind;
+        for (int i = 0; i < MAX_NODE_INPUTS; ++i) r.inputs[i] = inputs[i];
+        for (int i = 0; i < 4; ++i) r.values[i] = k[i];
+    }
+    void from_record(const PresetSource& r) override {
+        for (int i = 0; i < MAX_NODE_INPUTS; ++i) inputs[i] = r.inputs[i];
+        for (int i = 0; i < 4; ++i) k[i] = r.values[i];
     }
 };
 
 // Unified manager for all value sources
 class ValueSourceManager {
 private:
+    GeneratorBank generators;            // Declared first, generators detach from it when destroyed
     std::vector<std::unique_ptr<ValueSource>> sources;
+    std::vector<ValueSource*> scalarSources; // Sources updated one by one, everything but generators
     std::vector<std::pair<int, int>> links; // sourceId -> parameterIndex
     int nextSourceId = 0; // Auto-generate unique IDs
+    ModulationProgram program;  // UI-side copy: where loads come from and where results go
+    bool dirty = true;          // Sources, links or node settings changed since the program was compiled
+    GraphExecutor executor{CURVE_SAMPLES};
+    std::vector<float> loads, results, registers;
+    std::vector<std::pair<ValueSource*, int>> displays; // Processing node -> register, for the UI
+    std::vector<int> loadRegisters; // Registers handed out to leaf sources while lowering
+    std::vector<std::pair<MultiModeValueGenerator*, int>> waveLoads; // Generator -> load it feeds
+    std::vector<GeneratorWave> waves;
+    float frameDelta = 0.0f;
+
+    // Generators become bank lanes, everything else is updated on its own
+    void adopt(ValueSource* source) {
+        if (MultiModeValueGenerator* gen = dynamic_cast<MultiModeValueGenerator*>(source)) {
+            gen->attach(&generators);
+        } else {
+            scalarSources.push_back(source);
+        }
+    }
+
+    int indexOf(int sourceId) const {
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (sources[i]->getSourceId() == sourceId) return i;
+        }
+        return -1;
+    }
+
+    // Does source a read b, directly or through processing nodes? Layouts from older presets may already
+    // hold a cycle, so each node is walked once.
+    bool dependsOn(int a, int b) const {
+        std::vector<char> visited(sources.size(), 0);
+        return dependsOn(a, b, visited);
+    }
+    bool dependsOn(int a, int b, std::vector<char>& visited) const {
+        if (a == b) return true;
+        int index = indexOf(a);
+        if (index < 0 || visited[index]) return false;
+        visited[index] = 1;
+        ProcessingNode* node = dynamic_cast<ProcessingNode*>(sources[index].get());
+        if (!node) return false;
+        for (int i = 0; i < node->getInputCount(); ++i) {
+            if (node->getInput(i) >= 0 && dependsOn(node->getInput(i), b, visited)) return true;
+        }
+        return false;
+    }
+
+    // Depth-first post-order from the parameters back through the node inputs, so every op follows the
+    // ops it reads. Leaf sources get load registers, nodes get registers in evaluation order.
+    // Returns the register holding the source, and whether its values are positive amplitudes.
+    int lower(int index, std::vector<int>& registerOf, std::vector<char>& positive, std::vector<char>& visiting) {
+        if (registerOf[index] >= 0) return registerOf[index];
+        ValueSource* source = sources[index].get();
+        ProcessingNode* node = dynamic_cast<ProcessingNode*>(source);
+        if (!node) {
+            registerOf[index] = program.registerCount++;
+            positive[index] = source->isAudio();
+            if (MultiModeValueGenerator* gen = dynamic_cast<MultiModeValueGenerator*>(source)) {
+                waveLoads.emplace_back(gen, (int)program.inputs.size());
+            }
+            program.inputs.push_back(source->valueSlot());
+            loadRegisters.push_back(registerOf[index]);
+            return registerOf[index];
+        }
+        visiting[index] = 1;
+        ModulationOp op;
+        op.kind = node->getKind();
+        op.node = node->getSourceId();
+        for (int c = 0; c < 4; ++c) op.k[c] = node->getConstants()[c];
+        bool firstPositive = false;
+        for (int i = 0; i < MAX_NODE_INPUTS; ++i) {
+            int from = i < node->getInputCount() ? indexOf(node->getInput(i)) : -1;
+            op.in[i] = node->getInputDefault();
+            if (from < 0 || visiting[from]) continue; // Unconnected, or a cycle loaded from an old preset
+            op.in[i] = lower(from, registerOf, positive, visiting);
+            if (i == 0) firstPositive = positive[from];
+        }
+        visiting[index] = 0;
+        switch (op.kind) {
+            case ModulationKind::MapRange: positive[index] = op.k[2] >= 0.0f && op.k[3] >= 0.0f; break;
+            case ModulationKind::Clamp:    positive[index] = op.k[0] >= 0.0f || firstPositive; break;
+            case ModulationKind::Lfo:      positive[index] = false; break;
+            default:                       positive[index] = firstPositive; break;
+        }
+        op.out = program.registerCount++;
+        registerOf[index] = op.out;
+        program.ops.push_back(op);
+        displays.emplace_back(source, op.out);
+        return op.out;
+    }
+
+    // Lowers the patch to a ModulationProgram and hands it to the executor. Links to missing sources or
+    // out-of-range parameters are dropped here instead of every hop.
+    void compile(UniformMeta* metadata, int paramCount) {
+        program = ModulationProgram();
+        displays.clear();
+        loadRegisters.clear();
+        waveLoads.clear();
+        std::vector<int> registerOf(sources.size(), -1);
+        std::vector<char> positive(sources.size(), 0), visiting(sources.size(), 0);
+        std::vector<std::pair<int, int>> sorted = links;
+        std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.second < b.second; });
+        std::vector<ModulationOp> stores;
+        for (const auto& link : sorted) {
+            int paramIndex = link.second;
+            int index = indexOf(link.first);
+            if (paramIndex < 0 || paramIndex >= paramCount || index < 0) continue;
+            ModulationOp op = {};
+            op.kind  = ModulationKind::Store;
+            op.in[0] = lower(index, registerOf, positive, visiting);
+            op.out   = program.params.size();
+            const UniformMeta& um = metadata[paramIndex];
+            float range = um.max - um.min;
+            if (positive[index]) {
+                // Positive amplitudes map directly onto the range, saturating at twice unity
+                op.k[0] = range * 0.5f;  op.k[1] = um.min;  op.k[2] = range;
+            } else {
+                // Zero-mean waves are centred, a quarter of the half-range per unit
+                op.k[0] = range * 0.125f;  op.k[1] = (um.max + um.min) * 0.5f;  op.k[2] = INFINITY;
+            }
+            program.params.push_back(um.value);
+            program.paramIndex.push_back(paramIndex);
+            stores.push_back(op);
+        }
+        program.ops.insert(program.ops.end(), stores.begin(), stores.end());
+
+        // Registers were handed out in visiting order, the executor wants all loads in one block
+        std::vector<int> renumber(program.registerCount);
+        for (int r = 0; r < FIRST_LOAD_REGISTER; ++r) renumber[r] = r;
+        int next = FIRST_LOAD_REGISTER;
+        for (int r : loadRegisters) renumber[r] = next++;
+        for (const auto& display : displays) renumber[display.second] = next++;
+        for (ModulationOp& op : program.ops) {
+            for (int i = 0; i < MAX_NODE_INPUTS; ++i) op.in[i] = renumber[op.in[i]];
+            if (op.kind != ModulationKind::Store) op.out = renumber[op.out];
+        }
+        for (auto& display : displays) display.second = renumber[display.second];
+
+        loads.resize(program.inputs.size());
+        executor.install(program);
+        dirty = false;
+    }
     
 public:
     ValueSourceManager() = default;
@@ -337,7 +647,9 @@ public:
     int addSource(std::unique_ptr<ValueSource> source) {
         int newId = nextSourceId++;
         source->setSourceId(newId); // Set the auto-generated ID
+        adopt(source.get());
         sources.push_back(std::move(source));
+        dirty = true;
         return newId;
     }
     
@@ -348,6 +660,13 @@ public:
             [sourceId](const std::pair<int, int>& link) {
                 return link.first == sourceId;
             }), links.end());
+        for (auto& source : sources) {
+            if (ProcessingNode* node = dynamic_cast<ProcessingNode*>(source.get())) {
+                for (int i = 0; i < MAX_NODE_INPUTS; ++i) {
+                    if (node->getInput(i) == sourceId) node->setInput(i, -1);
+                }
+            }
+        }
         
         // Remove the source
         auto it = std::find_if(sources.begin(), sources.end(),
@@ -355,7 +674,9 @@ public:
                 return source->getSourceId() == sourceId;
             });
         
+        dirty = true;
         if (it != sources.end()) {
+            scalarSources.erase(std::remove(scalarSources.begin(), scalarSources.end(), it->get()), scalarSources.end());
             sources.erase(it);
             return true;
         }
@@ -374,26 +695,78 @@ public:
     
     // Update all sources
     void updateAll(float deltaTime) {
-        for (auto& source : sources) {
+        for (ValueSource* source : scalarSources) {
             source->update(deltaTime);
         }
+        generators.update(deltaTime);
+        frameDelta = deltaTime;
     }
     
-    // Apply values to parameters based on links
-    void applyToParameters(UniformMeta* metadata, int paramCount) {
-        for (const auto& link : links) {
-            int sourceId = link.first;
-            int paramIndex = link.second;
-            
-            if (paramIndex >= 0 && paramIndex < paramCount) {
-                ValueSource* source = getSource(sourceId);
-                if (source) {
-                    UniformMeta& um = metadata[paramIndex];
-                    *um.value = source->getProcessedValue(um);
-                }
-            }
+    // Queues one executor step for this hop with the current source values, recompiling after an edit.
+    // time stamps the end of the hop, in monotonicSeconds().
+    void submitStep(UniformMeta* metadata, int paramCount, double time = 0.0) {
+        for (auto& source : sources) {
+            if (source->consumeEdit()) dirty = true;
+        }
+        if (dirty) compile(metadata, paramCount);
+        for (size_t i = 0; i < loads.size(); ++i) loads[i] = *program.inputs[i];
+        // Periodic generators go by their cycle, so the executor can evaluate them between frames
+        waves.clear();
+        for (const auto& wl : waveLoads) {
+            GeneratorWave w;
+            if (!wl.first->wave(w)) continue;
+            w.load = wl.second;
+            waves.push_back(w);
+        }
+        executor.submit(loads, waves, frameDelta, time);
+    }
+
+    // Writes the parameter values of the latest finished step, and their curves across that step when
+    // given somewhere to put them. Parameters keep their values until the first step of a new program
+    // is done, but lose their curves as soon as nothing drives them.
+    void applyToParameters(ParamCurves* curves = nullptr) {
+        if (dirty) return;
+        uint32_t driven = 0;
+        for (int index : program.paramIndex) driven |= 1u << index;
+        if (curves) curves->mask &= driven;
+
+        double time;
+        float dt;
+        if (!executor.collect(results, registers, time, dt)) return;
+        const size_t params = program.params.size();
+        const float* last = results.data() + (CURVE_SAMPLES - 1) * params;
+        for (size_t i = 0; i < params; ++i) *program.params[i] = last[i];
+        for (const auto& display : displays) display.first->setValue(registers[display.second]);
+        if (!curves || dt <= 0.0f) return;
+
+        curves->start = time - dt;
+        curves->step  = dt / (CURVE_SAMPLES - 1);
+        curves->mask  = driven;
+        for (size_t i = 0; i < params; ++i) {
+            for (int s = 0; s < CURVE_SAMPLES; ++s) curves->samples[program.paramIndex[i]][s] = results[s * params + i];
         }
     }
+
+    const ModulationProgram& getProgram() const { return program; }
+
+    // Connects a source to a processing node input, refusing links that would close a cycle
+    bool connectInput(int sourceId, int nodeId, int input) {
+        int index = indexOf(nodeId);
+        ProcessingNode* node = index < 0 ? nullptr : dynamic_cast<ProcessingNode*>(sources[index].get());
+        if (!node || input < 0 || input >= node->getInputCount() || indexOf(sourceId) < 0) return false;
+        if (dependsOn(sourceId, nodeId)) return false;
+        node->setInput(input, sourceId);
+        dirty = true;
+        return true;
+    }
+
+    void disconnectInput(int nodeId, int input) {
+        int index = indexOf(nodeId);
+        ProcessingNode* node = index < 0 ? nullptr : dynamic_cast<ProcessingNode*>(sources[index].get());
+        if (!node || input < 0 || input >= MAX_NODE_INPUTS) return;
+        node->setInput(input, -1);
+        dirty = true;
+    }
     
     // Link management
     void addLink(int sourceId, int paramIndex) {
@@ -411,6 +784,7 @@ public:
             }), links.end());
         
         links.emplace_back(sourceId, paramIndex);
+        dirty = true;
     }
     
     void removeLink(int sourceId, int paramIndex) {
@@ -427,6 +801,7 @@ public:
                     return link.first == sourceId && link.second == paramIndex;
                 }), links.end());
         }
+        dirty = true;
     }
     
     // Check if a parameter is being driven by any source
@@ -467,8 +842,8 @@ public:
             int sourceId = attributeId / 10;
             return sourceId; // Return band index as source ID
         }
-        // Value generators: attributeId = 2000 + sourceId
-        if (attributeId >= 2000) {
+        // Value generators and processing nodes: attributeId = 2000 + sourceId
+        if (AttributeHelpers::isValueGeneratorAttribute(attributeId)) {
             int sourceId = attributeId - 2000;
             // Verify this source exists
             for (auto& source : sources) {
@@ -493,27 +868,38 @@ public:
         return j;
     }
 
-    void from_json(const nlohmann::json& j, float* audio_bands) {
+    void from_json(const nlohmann::json& j, float* audio_bands, float* channel_bands = nullptr) {
         sources.clear();
+        scalarSources.clear();
         links.clear();
         nextSourceId = 0;
+        dirty = true;
         if (j.contains("sources")) {
             for (const auto& srcj : j["sources"]) {
                 std::string type = srcj["type"].get<std::string>();
                 std::unique_ptr<ValueSource> src;
                 if (type == "audio_band") {
                     int bandIdx = srcj["bandIndex"].get<int>();
-                    src = std::make_unique<AudioBandSource>(bandIdx, &audio_bands[bandIdx]);
+                    int channel = srcj.value("channel", 0);
+                    float* data = (channel && channel_bands) ? &channel_bands[channel * BAND_COUNT + bandIdx]
+                                                             : &audio_bands[bandIdx];
+                    src = std::make_unique<AudioBandSource>(bandIdx, data, channel_bands ? channel : 0);
                     src->from_json(srcj);
                 } else if (type == "generator") {
                     auto gen = std::make_unique<MultiModeValueGenerator>();
                     gen->from_json(srcj);
                     src = std::move(gen);
+                } else if (type == "processor") {
+                    int kind = srcj.value("kind", 0);
+                    if (kind < 0 || kind >= MODULATION_NODE_KINDS) continue;
+                    src = std::make_unique<ProcessingNode>((ModulationKind)kind);
+                    src->from_json(srcj);
                 }
                 if (src) {
                     int sid = srcj["sourceId"].get<int>();
                     src->setSourceId(sid);
                     if (sid >= nextSourceId) nextSourceId = sid + 1;
+                    adopt(src.get());
                     sources.push_back(std::move(src));
                 }
             }
@@ -524,6 +910,55 @@ public:
             }
         }
     }
+
+    void to_preset(std::vector<PresetSource>& records, std::vector<PresetLink>& presetLinks) const {
+        records.clear();
+        presetLinks.clear();
+        for (const auto& src : sources) {
+            PresetSource r = {};
+            r.source_id = src->getSourceId();
+            for (int i = 0; i < MAX_NODE_INPUTS; ++i) r.inputs[i] = -1;
+            src->to_record(r);
+            records.push_back(r);
+        }
+        for (const auto& link : links) presetLinks.push_back({link.first, link.second});
+    }
+
+    int getNextSourceId() const { return nextSourceId; }
+
+    // Same as from_json, straight from a mapped binary preset
+    void from_preset(const PresetFile& preset, float* audio_bands, float* channel_bands = nullptr) {
+        sources.clear();
+        scalarSources.clear();
+        links.clear();
+        dirty = true;
+        nextSourceId = preset.header->next_source_id;
+        sources.reserve(preset.header->sources);
+        for (uint32_t i = 0; i < preset.header->sources; ++i) {
+            const PresetSource& r = preset.sources[i];
+            std::unique_ptr<ValueSource> src;
+            if (r.type == PRESET_AUDIO_BAND) {
+                if (r.a < 0 || r.a >= BAND_COUNT || r.b < 0 || r.b >= MAX_AUDIO_CHANNELS) continue;
+                float* data = (r.b && channel_bands) ? &channel_bands[r.b * BAND_COUNT + r.a] : &audio_bands[r.a];
+                src = std::make_unique<AudioBandSource>(r.a, data, channel_bands ? r.b : 0);
+            } else if (r.type == PRESET_GENERATOR) {
+                if (r.a < 0 || r.a >= GENERATOR_MODES) continue;
+                src = std::make_unique<MultiModeValueGenerator>();
+            } else if (r.type == PRESET_PROCESSOR) {
+                if (r.a < 0 || r.a >= MODULATION_NODE_KINDS) continue;
+                src = std::make_unique<ProcessingNode>((ModulationKind)r.a);
+            }
+            if (!src) continue;
+            src->from_record(r);
+            src->setSourceId(r.source_id);
+            if (r.source_id >= nextSourceId) nextSourceId = r.source_id + 1;
+            adopt(src.get());
+            sources.push_back(std::move(src));
+        }
+        for (uint32_t i = 0; i < preset.header->links; ++i) {
+            links.emplace_back(preset.links[i].source_id, preset.links[i].param_index);
+        }
+    }
 };
 
 #endif // GUI_NODES_H 
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#define LATENCY_REPORT_EVERY 32 // Impulses between running reports
+
+// Seconds on the monotonic clock; comparable between select and the renderers on one machine.
+inline double monotonicSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Distribution of capture -> FFT -> routing -> uniform upload latency for injected impulses.
+struct LatencyStats {
+    struct Sample { double fft, routing, upload; }; // Milliseconds since the impulse was captured
+    std::vector<Sample> samples;
+    unsigned last_seq = 0;
+    bool primed = false;
+
+    // Called right after the band uniforms were handed to GL.
+    void afterUpload(double capture, double analysis, double routing, unsigned impulse_seq) {
+        if (!primed) {
+            // An impulse analysed before this renderer started says nothing about it
+            primed = true;
+            last_seq = impulse_seq;
+            return;
+        }
+        if (impulse_seq == last_seq) return;
+        last_seq = impulse_seq;
+
+        double upload = monotonicSeconds();
+        samples.push_back({1000.0 * (analysis - capture), 1000.0 * (routing - capture), 1000.0 * (upload - capture)});
+        if (samples.size() % LATENCY_REPORT_EVERY == 0) report();
+    }
+
+    void report() const {
+        if (samples.empty()) return;
+        std::cout << "Latency over " << samples.size() << " impulses (ms)   min / median / p95 / max\n";
+        printStage("  capture->fft     ", &Sample::fft);
+        printStage("  capture->routing ", &Sample::routing);
+        printStage("  capture->upload  ", &Sample::upload);
+    }
+
+    ~LatencyStats() { report(); }
+private:
+    void printStage(const char* label, double Sample::* stage) const {
+        std::vector<double> values;
+        for (const Sample& s : samples) values.push_back(s.*stage);
+        std::sort(values.begin(), values.end());
+        auto at = [&](double q) { return values[std::min(values.size() - 1, size_t(q * values.size()))]; };
+        std::cout << label << std::fixed << std::setprecision(2)
+                  << values.front() << " / " << at(0.5) << " / " << at(0.95) << " / " << values.back() << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+};
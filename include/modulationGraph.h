@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "generatorBank.h"
+
+#define MAX_NODE_INPUTS 4
+
+// Registers 0 and 1 always hold 0 and 1, the defaults of unconnected inputs
+#define REGISTER_ZERO 0
+#define REGISTER_ONE  1
+#define FIRST_LOAD_REGISTER 2
+
+enum class ModulationKind : uint8_t {
+    Add,        // in0 + in1 + in2 + in3
+    Multiply,   // in0 * in1 * in2 * in3
+    Clamp,      // in0 limited to [k0, k1]
+    MapRange,   // in0 mapped from [k0, k1] onto [k2, k3]
+    Slew,       // in0 followed at k0 units/s rising, k1 units/s falling
+    SampleHold, // in0 sampled when trigger in1 crosses k0
+    Lfo,        // k2 * wave k1 at k0 Hz, times (1 + in1), phase reset when sync in0 crosses 0.5
+    Store       // Parameter out = k1 + min(in0 * k0, k2)
+};
+constexpr int MODULATION_NODE_KINDS = (int)ModulationKind::Store;
+
+// One instruction: reads registers, writes a register (or a parameter for Store). Stateful kinds keep
+// their memory in state, which the executor carries across recompiles by node.
+struct ModulationOp {
+    ModulationKind kind;
+    int out;
+    int in[MAX_NODE_INPUTS];
+    float k[4];
+    int node = -1;           // Source id of the processing node
+    float state[2] = {0.0f, 0.0f};
+};
+
+// Flat program compiled from the patch graph. Sources are loaded into registers, processing ops follow
+// in topological order and Stores come last, sorted by parameter.
+struct ModulationProgram {
+    int registerCount = FIRST_LOAD_REGISTER;
+    std::vector<const float*> inputs; // Register FIRST_LOAD_REGISTER + i is loaded from inputs[i]
+    std::vector<float*> params;       // Dense parameter index -> uniform
+    std::vector<int> paramIndex;      // Dense parameter index -> UniformMeta index
+    std::vector<ModulationOp> ops;
+
+    void run(float* registers, float* results, float dt);
+    void adoptState(const ModulationProgram& previous);
+};
+
+// Runs the installed program on its own thread, one step per analysed hop. The UI thread only copies
+// source values in and the final parameter values out. With more than one sample per step the program
+// is sub-stepped across the hop: periodic generators are evaluated at each sub-step from their cycle,
+// other sources interpolated from the previous hop's values. Each step yields a curve per parameter: the previous step's last sample, then samples - 1 evenly spaced ones.
+class GraphExecutor {
+public:
+    GraphExecutor(int samples = 1);
+    ~GraphExecutor();
+    GraphExecutor(const GraphExecutor&) = delete;
+    GraphExecutor& operator=(const GraphExecutor&) = delete;
+
+    void install(const ModulationProgram& program); // Drops any step still queued for the old program
+    void submit(const std::vector<float>& loads, const std::vector<GeneratorWave>& waves, float dt, double time = 0.0);
+    // Latest finished step of the installed program, false if there is none yet. results holds
+    // samples x parameters, sample-major; time and dt are those the step was submitted with.
+    bool collect(std::vector<float>& results, std::vector<float>& registers, double& time, float& dt);
+    int sampleCount() const { return samples; }
+private:
+    void loop();
+    void step(const std::vector<float>& loads, const std::vector<GeneratorWave>& waves, float dt,
+              std::vector<float>& registers, std::vector<float>& results);
+
+    const int samples;
+    std::vector<float> previous_loads; // Worker side, the last hop's sources and results
+    std::vector<float> previous_results;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    ModulationProgram program;       // Worker side
+    ModulationProgram next_program;
+    bool program_pending = false;
+    unsigned generation = 0;         // Installs so far
+
+    std::vector<float> step_loads;
+    std::vector<GeneratorWave> step_waves;
+    float step_dt = 0.0f;
+    double step_time = 0.0;
+    bool step_pending = false;
+
+    std::vector<float> out_results, out_registers;
+    float out_dt = 0.0f;
+    double out_time = 0.0;
+    unsigned out_generation = 0;
+    bool out_ready = false;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define DEFAULT_GROUP "default"
+
+// Parameter bus: every instance group has its own shared-memory block and Unix-domain socket, so
+// several shows can run on one host. select publishes into the block and then sends the new
+// sequence number to every renderer connected to the group's socket.
+std::string groupPath(const std::string& group, const char* suffix);
+
+class BusServer {
+public:
+    BusServer() = default;
+    BusServer(const BusServer&) = delete;
+    BusServer& operator=(const BusServer&) = delete;
+    ~BusServer();
+
+    bool listen(const std::string& socket_path);
+    void acceptPending();
+    void notify(uint32_t sequence);
+    int clientCount() const { return clients.size(); }
+private:
+    int fd = -1;
+    std::string path;
+    std::vector<int> clients;
+};
+
+class BusClient {
+public:
+    BusClient() = default;
+    BusClient(const BusClient&) = delete;
+    BusClient& operator=(const BusClient&) = delete;
+    ~BusClient() { disconnect(); }
+
+    bool connect(const std::string& socket_path);
+    void disconnect();
+    bool connected() const { return fd != -1; }
+    bool drain();               // Consumes pending notifications, true if there were any
+    bool wait(int timeout_ms);  // Blocks until a notification is pending or the timeout passes
+private:
+    int fd = -1;
+};
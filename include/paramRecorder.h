@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "sharedUniforms.h"
+
+// Parameter stream recordings: a header, then one frame per published change holding the time
+// since recording started and the 4-byte words of UniformStructure that differ from the previous
+// frame. The first frame is diffed against zeroes and so carries the full state.
+#define RECORDING_MAGIC   0x52504F44 // "DOPR"
+#define RECORDING_VERSION 1
+
+static_assert(sizeof(UniformStructure) % 4 == 0, "recordings diff UniformStructure word by word");
+constexpr int RECORDING_WORDS = sizeof(UniformStructure) / 4;
+
+struct RecordingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;  // UNIFORMS_VERSION the recording was made with
+    uint32_t size;    // sizeof(UniformStructure)
+};
+
+class ParamRecorder {
+public:
+    ~ParamRecorder() { close(); }
+    bool open(const std::string& path);
+    void close();
+    bool recording() const { return file != nullptr; }
+    void record(float time, const UniformStructure& u);
+    std::string path;
+private:
+    FILE* file = nullptr;
+    uint32_t previous[RECORDING_WORDS];
+    std::vector<uint8_t> frame;
+};
+
+class ParamPlayer {
+public:
+    bool open(const std::string& path);
+    bool loaded() const { return !bytes.empty(); }
+    bool finished() const { return loaded() && cursor >= bytes.size(); }
+    // Applies every frame up to `time`; returns true if `out` changed.
+    bool advance(float time, UniformStructure& out);
+private:
+    std::vector<uint8_t> bytes;
+    size_t cursor = 0;
+    uint32_t state[RECORDING_WORDS] = {0};
+};
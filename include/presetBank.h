@@ -0,0 +1,125 @@
+#ifndef PRESET_BANK_H
+#define PRESET_BANK_H
+
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include "guiNodes.h"
+#include "presetFormat.h"
+
+#define PRESET_SLOTS 3            // Save/Load slots 1..PRESET_SLOTS, slot 0 is the graph select starts with
+#define PRESET_DIR   "tmp"
+#define DEFAULT_CROSSFADE 1.0f    // Seconds
+
+// Every preset slot preloaded into its own ValueSourceManager, so switching is a change of index. During
+// a crossfade both graphs keep running and the parameters they drive are blended from the old graph's
+// values to the new one's.
+class PresetBank {
+public:
+    float crossfade = DEFAULT_CROSSFADE;
+
+    ValueSourceManager& current() { return managers[active]; }
+    int currentSlot() const { return active; }
+    bool fading() const { return previous >= 0; }
+    float fadeProgress() const { return progress; }
+    bool occupied(int slot) const { return filled[slot]; }
+    const std::string& layout(int slot) const { return layouts[slot]; }
+
+    static std::string slotPath(int slot, const char* extension) {
+        return std::string(PRESET_DIR) + "/nodes_config_slot" + std::to_string(slot) + extension;
+    }
+
+    // Preloads a slot from its binary preset, or from the JSON one when there is no binary yet
+    bool load(int slot, float* audio_bands, float* channel_bands) {
+        PresetFile preset;
+        if (preset.open(slotPath(slot, ".preset"))) {
+            managers[slot].from_preset(preset, audio_bands, channel_bands);
+            layouts[slot].assign(preset.ini, preset.header->ini_bytes);
+            return filled[slot] = true;
+        }
+        std::ifstream jfs(slotPath(slot, ".json"));
+        if (!jfs) return false;
+        nlohmann::json j;
+        jfs >> j;
+        managers[slot].from_json(j, audio_bands, channel_bands);
+        std::ifstream ifs(slotPath(slot, ".ini"), std::ios::binary);
+        layouts[slot].assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        return filled[slot] = true;
+    }
+
+    // Writes the current graph to a slot as binary, JSON for interchange, and the editor layout
+    bool save(int slot, const std::string& ini) {
+        std::filesystem::create_directories(PRESET_DIR);
+        std::vector<PresetSource> records;
+        std::vector<PresetLink> presetLinks;
+        current().to_preset(records, presetLinks);
+        if (!writePresetFile(slotPath(slot, ".preset"), current().getNextSourceId(), records, presetLinks, ini)) {
+            return false;
+        }
+        std::ofstream jfs(slotPath(slot, ".json"));
+        if (jfs) jfs << current().to_json().dump(2);
+        std::ofstream ofs(slotPath(slot, ".ini"), std::ios::binary);
+        if (ofs) ofs.write(ini.data(), ini.size());
+        if (slot == active) layouts[slot] = ini;
+        return true;
+    }
+
+    // Starts a crossfade to a preloaded slot. Returns false when the slot is empty or already playing.
+    bool switchTo(int slot, UniformMeta* metadata) {
+        if (slot == active || !filled[slot]) return false;
+        previous = active;
+        active = slot;
+        progress = crossfade > 0.0f ? 0.0f : 1.0f;
+        for (int j = 0; j < PARAM_COUNT; ++j) from[j] = to[j] = *metadata[j].value;
+        return true;
+    }
+
+    void updateAll(float deltaTime) {
+        current().updateAll(deltaTime);
+        if (previous < 0) return;
+        managers[previous].updateAll(deltaTime);
+        progress += crossfade > 0.0f ? deltaTime / crossfade : 1.0f;
+    }
+
+    void submitStep(UniformMeta* metadata, int paramCount, double time) {
+        current().submitStep(metadata, paramCount, time);
+        if (previous >= 0) managers[previous].submitStep(metadata, paramCount, time);
+    }
+
+    // Each graph writes its parameters over the values it wrote last, then the two are blended.
+    // Curves are left out while fading, renderers follow the blended scalars.
+    void applyToParameters(UniformMeta* metadata, ParamCurves* curves) {
+        if (previous >= 0 && progress >= 1.0f) previous = -1;
+        if (previous < 0) {
+            current().applyToParameters(curves);
+            return;
+        }
+        // Parameters neither graph drives stay with the sliders
+        ValueSourceManager& old = managers[previous];
+        for (int j = 0; j < PARAM_COUNT; ++j) {
+            if (!old.isParameterDriven(j) && !current().isParameterDriven(j)) from[j] = to[j] = *metadata[j].value;
+        }
+        float t = progress * progress * (3.0f - 2.0f * progress);
+        for (int j = 0; j < PARAM_COUNT; ++j) *metadata[j].value = from[j];
+        old.applyToParameters(nullptr);
+        for (int j = 0; j < PARAM_COUNT; ++j) from[j] = *metadata[j].value;
+        for (int j = 0; j < PARAM_COUNT; ++j) *metadata[j].value = to[j];
+        current().applyToParameters(nullptr);
+        for (int j = 0; j < PARAM_COUNT; ++j) {
+            to[j] = *metadata[j].value;
+            *metadata[j].value = from[j] + t * (to[j] - from[j]);
+        }
+        if (curves) curves->mask = 0;
+    }
+
+private:
+    ValueSourceManager managers[PRESET_SLOTS + 1];
+    std::string layouts[PRESET_SLOTS + 1];
+    bool filled[PRESET_SLOTS + 1] = {true};
+    int active = 0;
+    int previous = -1; // Slot fading out
+    float progress = 1.0f;
+    float from[PARAM_COUNT], to[PARAM_COUNT]; // Last values each side of the crossfade wrote
+};
+
+#endif // PRESET_BANK_H
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Binary node layout presets written by select next to the JSON ones and memory-mapped when loaded.
+// Layout: PresetHeader, sources x PresetSource, links x PresetLink, then the ImNodes ini text.
+constexpr uint32_t PRESET_MAGIC   = 0x53504F44; // "DOPS"
+constexpr uint32_t PRESET_VERSION = 1;
+
+enum PresetSourceType : int32_t {
+    PRESET_AUDIO_BAND = 0,
+    PRESET_GENERATOR  = 1,
+    PRESET_PROCESSOR  = 2
+};
+
+struct PresetHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sources;
+    uint32_t links;
+    uint32_t ini_bytes;
+    int32_t  next_source_id;
+};
+
+// One node, whatever its type: a and b are band/channel, mode or kind; values are its settings
+struct PresetSource {
+    int32_t type;
+    int32_t source_id;
+    int32_t a, b;
+    int32_t inputs[4];
+    float   values[8];
+};
+static_assert(sizeof(PresetSource) == 64, "PresetSource is written as is");
+
+struct PresetLink {
+    int32_t source_id;
+    int32_t param_index;
+};
+
+struct PresetFile {
+    const PresetHeader* header = nullptr;
+    const PresetSource* sources = nullptr;
+    const PresetLink* links = nullptr;
+    const char* ini = nullptr;
+    size_t mapped_size = 0;
+
+    PresetFile() = default;
+    PresetFile(const PresetFile&) = delete;
+    PresetFile& operator=(const PresetFile&) = delete;
+    ~PresetFile() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+    bool loaded() const { return header != nullptr; }
+};
+
+bool writePresetFile(const std::string& path, int32_t next_source_id, const std::vector<PresetSource>& sources,
+                     const std::vector<PresetLink>& links, const std::string& ini);
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "graphicsPipe.h"
+
+#define HOSTED_WIDTH  1024
+#define HOSTED_HEIGHT 1024
+
+// Built once in the host's root context and used by every output. Programs and buffers are shared
+// across the group's contexts, vertex arrays are not: each output links its own over these buffers.
+struct SharedAssets {
+    ShaderProgram spin_shader;
+    PlayerContext spin_context;            // Map and dodecaplex buffers
+    std::mutex program_lock;               // Held to swap in or pick up a relinked spin_shader
+    std::atomic<unsigned> program_generation{0}; // Bumped by every relink
+    std::atomic<bool> reload_requested{false};   // Space pressed in an output
+    std::unique_ptr<ShaderWatcher> watcher;
+    bool loaded = false;
+
+    void load(GLFWwindow* root);
+    void update(); // Main thread: swaps in relinked programs
+};
+
+struct RenderOutput {
+    GraphicsPipe* pipe;
+    GLFWwindow* window;
+    const char* title;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> finished{false};
+    int shown_fps = 0; // Titles are set here, the render thread only counts
+};
+
+// Runs GraphicsPipe outputs in this process, each in a window of its own that shares the root
+// context's objects and renders on its own thread, so one output waiting on vsync never holds back
+// another. GLFW wants windows made, polled and retitled on the main thread: poll() does that part.
+class RendererHost {
+public:
+    RendererHost(GLFWwindow* root) : root(root) {}
+    ~RendererHost();
+    RendererHost(const RendererHost&) = delete;
+    RendererHost& operator=(const RendererHost&) = delete;
+
+    bool addOutput(PipeType type, const CLAs& clas); // Main thread, root context current
+    void poll();     // Main thread: shader reloads, titles, and outputs whose window was closed
+    void closeAll();
+    int outputCount() const { return outputs.size(); }
+private:
+    static void run(RenderOutput* output, SharedAssets* assets);
+
+    GLFWwindow* root;
+    SharedAssets assets;
+    std::vector<RenderOutput*> outputs;
+};
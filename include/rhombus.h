@@ -35,6 +35,12 @@ enum WebType {
     DOUBLE_STAR
 };
 
+enum WebDetail {
+    FULL_WEB,
+    PLAIN_PENTAGON, // 5 triangles from the center of the web to its corners
+    WEB_DETAILS
+};
+
 struct RhombusIndeces {
     GLuint triangle_a[3];
     GLuint triangle_b[3];
@@ -98,6 +104,9 @@ struct RhombusPattern {
     RhombusPattern(WebType pattern, bool flip);
     void buildArrays(CPUBufferPair& buffer_writer, PentagonMemory& pentagon, bool include_normals);
     void buildArrays(CPUBufferPair& buffer_writer, PentagonMemory& pentagon);
+    void buildIndeces(CPUBufferPair& buffer_writer, PentagonMemory& pentagon, WebDetail detail);
+        // Indexes the vertices buildArrays already wrote for pentagon, at any detail
+    std::array<GLuint, 15> pentagon_indeces; // PLAIN_PENTAGON, relative to the web's first vertex
     std::array<glm::vec4,5> web_pentagon;
     std::array<std::pair<GoldenRhombus*, Corner>, 5> corners;
     void applyDamage(CPUBufferPair& buffer_writer, glm::mat4 player_view, PentagonMemory& pentagon);
@@ -119,6 +128,7 @@ private:
     void addRhombuses(std::array<GoldenRhombus, N>& rhombuses, SplitType split);
     void assignCorners(std::array<GoldenRhombus, 5>& rhombuses, Corner corner);
     void assignCorners(std::array<GoldenRhombus*, 5> rhombuses, Corner corner);
+    void assignFan(std::array<GLuint, 5> corner_indeces);
     template<long unsigned int N>
     void assignEdge(std::array<GoldenRhombus*, N> rhombuses, int edge_index);
     void rescaleValues();
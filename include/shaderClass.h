@@ -7,28 +7,66 @@
 #include <sstream>
 #include <iostream>
 #include <cerrno>
+#include <vector>
 #include "textures.h"
 
-std::string get_file_contents(const std::string& filename, const std::string& parentPath);
+#define PROGRAM_CACHE_DIR "tmp/programs" // Linked program binaries, keyed by expanded sources and driver
+
+// A replacement program on its way through the driver. Begin only issues work, so where the driver
+// compiles in parallel it can be polled for completion instead of waited on.
+struct PendingProgram {
+	GLuint program = 0;
+	GLuint shaders[3] = {0, 0, 0}; // Vertex, geometry, fragment
+	std::string cachePath;
+	bool cached = false;
+	std::vector<std::string> files[3];     // Per stage, source string n of the compile log is files[n]
+	std::vector<std::string> dependencies; // Every file of every stage
+};
 
 class ShaderProgram {
 public:
 	GLuint ID;
 	ShaderProgram() : ID(0) {};
 	std::string vertex_path, geometry_path, fragment_path;	
+	std::vector<std::string> dependencies; // Absolute paths the current program was built from
+	std::vector<std::string> defines;      // Variant of the sources to build: "NAME" or "NAME VALUE"
 	ShaderProgram(	const std::string& vertexFile,\
 					const std::string& fragmentFile, bool load);
 	ShaderProgram(	const std::string& vertexFile,\
 					const std::string& geometryFile,
 					const std::string& fragmentFile, bool load);
-	void Load();
+	void Load(); // Blocking. A program that fails to link leaves the current one in place
+	PendingProgram Begin() const;
+	bool Check(PendingProgram& pending) const; // Waits for the link, false (and nothing left over) on failure
+	void Adopt(PendingProgram& pending);       // Replaces and frees the current program
 	void Activate();
 	void Delete();
 
 private:
 	bool include_geometry = false;
-	void checkCompileErrors(unsigned int shader, const char* type);
-	void checkLinkingErrors(unsigned int program);
+	void checkCompileErrors(unsigned int shader, const char* type, const std::vector<std::string>& files) const;
+	bool checkLinkingErrors(unsigned int program) const;
+};
+
+// One set of sources built as several programs, each with its own defines, so a draw picks the variant
+// it needs instead of branching or switching subroutines at run time. The uniforms all variants are
+// drawn with are looked up once per link.
+class ShaderVariants {
+public:
+	ShaderVariants() {};
+	ShaderVariants(const std::string& vertexFile, const std::string& geometryFile, const std::string& fragmentFile,
+				   const std::vector<std::vector<std::string>>& variantDefines, const std::vector<const char*>& uniformNames);
+	void Load();
+	void Locate(); // After any variant was (re)linked
+	ShaderProgram& operator[](int variant) { return programs[variant]; }
+	GLint Location(int variant, int uniform) const { return locations[variant * uniform_names.size() + uniform]; }
+	int Count() const { return programs.size(); }
+	std::vector<ShaderProgram*> Programs();
+
+private:
+	std::vector<ShaderProgram> programs; // Never resized after construction, watchers hold pointers
+	std::vector<const char*> uniform_names;
+	std::vector<GLint> locations;
 };
 
 #endif
\ No newline at end of file
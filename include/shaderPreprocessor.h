@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Expands a shader's #includes into one source for the compiler:
+//  - every file is included at most once per source, so shared headers need no guards
+//  - parsed files are cached across programs until their modification time changes
+//  - #version is moved to the top, followed by the variant's defines ("NAME" or "NAME VALUE")
+//  - #line marks every stretch taken from a file, source string n being files[n]
+// Throws errno, like the loader it replaces, when a file cannot be read.
+std::string preprocessShader(const std::string& path, const std::vector<std::string>& defines,
+                             std::vector<std::string>& files);
+
+// Replaces source string numbers in a compiler log with the file names they stand for
+std::string annotateShaderLog(const std::string& log, const std::vector<std::string>& files);
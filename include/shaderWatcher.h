@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "shaderClass.h"
+#include <GLFW/glfw3.h>
+
+// Relinks programs when a file they were built from (includes too) changes, or on request, without
+// stalling the frame. Drivers with parallel shader compile link on their own threads and are polled
+// once per frame; elsewhere a worker links in a hidden context sharing the renderer's objects. The
+// running program is only replaced once its successor has linked, and stays if it fails.
+class ShaderWatcher {
+public:
+    ShaderWatcher(GLFWwindow* share); // Main thread, with share's context current
+    ~ShaderWatcher();
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    void watch(ShaderProgram* program);
+    void reloadAll();
+    bool poll(); // Thread that draws with the programs, once per frame. True when one was replaced
+private:
+    struct Job {
+        ShaderProgram* program;
+        PendingProgram pending;
+        bool linked = false;
+    };
+    void watchDirectories(const ShaderProgram* program);
+    void request(ShaderProgram* program);
+    void compileLoop();
+
+    int inotify_fd = -1;
+    std::map<int, std::string> directories; // Watch descriptor -> directory
+    std::vector<ShaderProgram*> programs;
+    std::set<ShaderProgram*> busy;          // Being relinked
+    std::set<ShaderProgram*> stale;         // Changed again while being relinked
+    std::vector<Job> in_flight;             // Parallel compile: links the driver is running
+
+    bool parallel = false;
+    GLFWwindow* compile_context = nullptr;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<Job> to_link, linked;       // Worker queues, under mutex
+    bool stopping = false;
+};
@@ -1,10 +1,31 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <iostream>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include "latency.h"
+#include "bandFilter.h"
+#include "paramBus.h"
 
 #define BAND_COUNT 4
 #define PARAM_COUNT 10
+#define CURVE_SAMPLES 16 // Points per published parameter curve, spanning the producer's last frame
+static_assert(BAND_COUNT == 4, "BandFilter processes the bands as one 4-wide vector");
+
+// Sub-frame history of the parameters driven by the patch graph: sample i of parameter j is its value at
+// start + i * step in monotonicSeconds(). Parameters without their mask bit are plain scalars.
+struct ParamCurves {
+    double start;
+    float step;
+    uint32_t mask;
+    float samples[PARAM_COUNT][CURVE_SAMPLES];
+};
 
 struct UniformStructure {
     float scale;
@@ -22,6 +43,15 @@ struct UniformStructure {
     float band_volumes[BAND_COUNT];  // Individual band volume controls
     float audio_bands[BAND_COUNT];  // FFT band amplitudes
     int audio_routing[BAND_COUNT];  // Bit flags for parameter routing (bit 0=scale, 1=brightness, 2=speed, 3=fov, 4=hueShift)
+    BandFilterParams filter;        // Envelope, smoothing and AGC applied to the raw bands before routing
+
+    // Latency probes for the current audio_bands, in monotonicSeconds()
+    double capture_time;   // Newest samples (or the detected impulse) entered the capture callback
+    double analysis_time;  // Their bands were computed
+    double routing_time;   // They were routed into this structure
+    unsigned impulse_seq;  // Bumped each time an injected impulse reaches audio_bands
+
+    ParamCurves curves;    // Scalars above hold the newest sample of each curve
     UniformStructure() :    scale(0.0f),
                             brightness(1.0f),
                             speed(1.0f),
@@ -32,7 +62,13 @@ struct UniformStructure {
                             vignette(0.5f),
                             linePx(0.5f),
                             lineFade(0.5f),
-                            shatter(0.0f) {
+                            shatter(0.0f),
+                            filter{0.005f, 0.15f, 0.0f, 0.0f, 0.5f, 8.0f},
+                            capture_time(0.0),
+                            analysis_time(0.0),
+                            routing_time(0.0),
+                            impulse_seq(0),
+                            curves{} {
         for(int i = 0; i < BAND_COUNT; i++) {
             audio_bands[i] = 0.0f;
             band_volumes[i] = 1.0f;  // Default to full volume for each band
@@ -49,16 +85,41 @@ struct UniformMeta {
         value(v), min(x), max(y), name(n) {};
 };
 
+#define UNIFORMS_MAGIC   0x55574F44 // "DOWU"
+#define UNIFORMS_VERSION 2          // Bump whenever UniformStructure changes layout
+#define BUS_RETRY_FRAMES 120        // Syncs between attempts to reach a missing writer
+
+// What lives in a group's /tmp/uniforms*.dat. The writer publishes under a seqlock: sequence is odd while
+// the payload is being copied, and grows by two per published change.
+struct SharedBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    std::atomic<uint32_t> sequence;
+    UniformStructure payload;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "sequence must be usable across processes");
+
 struct SharedUniforms {
-    UniformStructure* data;
-    const char* loc = "/tmp/uniforms.dat";
-    int fd;
+    UniformStructure* data;   // Process-local working copy, stable for the lifetime of this object
+    UniformStructure local;
+    UniformStructure published;
+    SharedBlock* block = nullptr;
+    uint32_t generation = 1;  // Last sequence published or synced; odd means never synced
+    std::string loc;          // Shared block of this instance group
+    std::string socket_loc;   // Change notifications of this instance group
+    int fd = -1;
     bool should_unlink;
+    BusServer bus_server;     // Writer side
+    BusClient bus;            // Reader side
+    unsigned syncs = 0;
 
     UniformMeta metadata[PARAM_COUNT];
+    BandFilter band_filter; // Per-process state, only the parameters are shared
     
-    SharedUniforms(bool writeable)
-        : should_unlink(writeable),
+    SharedUniforms(bool writeable, const std::string& group = DEFAULT_GROUP)
+        : data(&local), loc(groupPath(group, ".dat")), socket_loc(groupPath(group, ".sock")),
+          should_unlink(writeable),
           metadata{
               UniformMeta(nullptr, 0.0f, 1.0f, "Scale"),
               UniformMeta(nullptr, 0.0f, 2.0f, "Brightness"),
@@ -72,7 +133,8 @@ struct SharedUniforms {
               UniformMeta(nullptr, 0.0f, 100.0f, "Shatter")
           }
     {
-        writeable ? openRW() : openR();
+        write();
+        writeable ? openRW() : attach();
         // Now update the value pointers after data is initialized
         metadata[0].value = &data->scale;
         metadata[1].value = &data->brightness;
@@ -85,40 +147,167 @@ struct SharedUniforms {
         metadata[8].value = &data->lineFade;
         metadata[9].value = &data->shatter;
     };
+    SharedUniforms(const SharedUniforms&) = delete;
+    SharedUniforms& operator=(const SharedUniforms&) = delete;
+
+    // Writer: copies the working copy into shared memory if anything changed since the last call.
+    void Publish(){
+        if (!block || !should_unlink) return;
+        bus_server.acceptPending();
+        if (sameParameters(local, published)) return;
+        published = local;
+
+        uint32_t seq = block->sequence.load(std::memory_order_relaxed);
+        block->sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy((void*)&block->payload, &published, sizeof(UniformStructure));
+        block->sequence.store(seq + 2, std::memory_order_release);
+        generation = seq + 2;
+        bus_server.notify(generation);
+    }
+
+    // The latency probes are restamped every frame and a curve's start moves with every producer frame,
+    // so they ride along with a change but never make one. Which parameters follow a curve still counts.
+    static bool sameParameters(const UniformStructure& a, const UniformStructure& b) {
+        return std::memcmp(&a, &b, offsetof(UniformStructure, capture_time)) == 0
+            && a.curves.mask == b.curves.mask;
+    }
+
+    // Reader: replaces each curve-driven parameter with its curve, one producer frame behind `now` so
+    // the newest frame's curve covers the present. Returns whether any parameter changed, so a held
+    // curve does not force an upload every frame.
+    bool SampleCurves(double now) {
+        const ParamCurves& c = data->curves;
+        if (!c.mask || c.step <= 0.0f) return false;
+        float x = (float)((now - c.start) / c.step) - (CURVE_SAMPLES - 1);
+        x = std::min(std::max(x, 0.0f), (float)(CURVE_SAMPLES - 1));
+        int i = std::min((int)x, CURVE_SAMPLES - 2);
+        float f = x - i;
+        bool changed = false;
+        for (int j = 0; j < PARAM_COUNT; ++j) {
+            if (!(c.mask & (1u << j))) continue;
+            float v = c.samples[j][i] + f * (c.samples[j][i + 1] - c.samples[j][i]);
+            changed |= v != *metadata[j].value;
+            *metadata[j].value = v;
+        }
+        return changed;
+    }
+
+    // Reader: refreshes the working copy with a consistent snapshot. Returns false when nothing was
+    // published since the last call, so uploads can be skipped. While connected to the group's socket
+    // that takes one non-blocking recv and shared memory is not touched; otherwise one acquire load.
+    bool Sync(){
+        if (!should_unlink && !bus.connected() && syncs++ % BUS_RETRY_FRAMES == 0) attach();
+        if (!block || should_unlink) {
+            bool first = generation & 1;
+            generation = 0;
+            return first;
+        }
+        if (bus.connected() && !bus.drain() && !(generation & 1)) return false;
+
+        uint32_t seq = block->sequence.load(std::memory_order_acquire);
+        if (seq == generation) return false;
+        while (true) {
+            if (seq & 1) {
+                seq = block->sequence.load(std::memory_order_acquire);
+                continue;
+            }
+            std::memcpy(&local, (const void*)&block->payload, sizeof(UniformStructure));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t check = block->sequence.load(std::memory_order_relaxed);
+            if (check == seq) break;
+            seq = check;
+        }
+        generation = seq;
+        return true;
+    }
+
+    // Reader: sleeps until select publishes a change, or timeout_ms passes.
+    void WaitForUpdate(int timeout_ms){
+        if (bus.connected()) bus.wait(timeout_ms);
+        else usleep(timeout_ms * 1000);
+    }
 
 private:
     void write(){
-        *data = UniformStructure();
+        local = UniformStructure();
+        published = local;
     };
     void openRW(){
-        fd = open(loc, O_RDWR | O_CREAT, 0666);
-        ftruncate(fd, sizeof(UniformStructure));
-        data = (UniformStructure*)mmap(NULL, sizeof(UniformStructure), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-        write();
+        fd = open(loc.c_str(), O_RDWR | O_CREAT, 0666);
+        if (fd == -1 || ftruncate(fd, sizeof(SharedBlock)) == -1) return;
+        void* mmap_ptr = mmap(NULL, sizeof(SharedBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mmap_ptr == MAP_FAILED) return;
+
+        block = (SharedBlock*)mmap_ptr;
+        block->sequence.store(1, std::memory_order_relaxed); // Readers wait until the first payload lands
+        block->magic   = UNIFORMS_MAGIC;
+        block->version = UNIFORMS_VERSION;
+        block->size    = sizeof(UniformStructure);
+        std::memcpy((void*)&block->payload, &published, sizeof(UniformStructure));
+        block->sequence.store(2, std::memory_order_release);
+        generation = 2;
+        bus_server.listen(socket_loc);
+    };
+    void attach(){
+        // (Re)maps the group's block whenever its writer can be reached; the block may have been
+        // recreated by a restarted select. Without a compatible writer the working copy keeps its values.
+        bool reached = bus.connect(socket_loc);
+        if (block && !reached) return;
+        detach();
+        generation = 1;
+        openR();
+    };
+    void detach(){
+        if (block) munmap(block, sizeof(SharedBlock));
+        if (fd != -1) close(fd);
+        block = nullptr;
+        fd = -1;
     };
     void openR(){
-        fd = open(loc, O_RDONLY);
-        if (fd != -1) {
-        void* mmap_ptr = mmap(NULL, sizeof(float), PROT_READ, MAP_SHARED, fd, 0);
-        if (mmap_ptr != MAP_FAILED) {
-            data = (UniformStructure*) mmap_ptr;
-        } else {            
-            close(fd);
-            *data = UniformStructure();
+        fd = open(loc.c_str(), O_RDONLY);
+        if (fd == -1) return;
+
+        struct stat info;
+        if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(SharedBlock)) {
+            std::cerr << "Shared uniforms at " << loc << " are from an older build, using defaults.\n";
+            return;
+        }
+        void* mmap_ptr = mmap(NULL, sizeof(SharedBlock), PROT_READ, MAP_SHARED, fd, 0);
+        if (mmap_ptr == MAP_FAILED) return;
+
+        SharedBlock* mapped = (SharedBlock*)mmap_ptr;
+        if (mapped->magic != UNIFORMS_MAGIC || mapped->version != UNIFORMS_VERSION
+            || mapped->size != sizeof(UniformStructure)) {
+            std::cerr << "Shared uniforms at " << loc << " have an incompatible layout, using defaults.\n";
+            munmap(mmap_ptr, sizeof(SharedBlock));
+            return;
         }
-    }    
+        block = mapped;
     };
 public:
     ~SharedUniforms(){
-        munmap(data, sizeof(UniformStructure));
-        close(fd);
+        detach();
         if (should_unlink) {
-            unlink(loc);
+            unlink(loc.c_str());
         }
     };
-    void ApplyRouting(std::atomic<float>* g_bandAmplitudes){
+    void StampLatency(double capture, double analysis, unsigned impulses){
+        data->capture_time  = capture;
+        data->analysis_time = analysis;
+        data->routing_time  = monotonicSeconds();
+        data->impulse_seq   = impulses;
+    }
+    void RecordUpload(LatencyStats& stats) const {
+        stats.afterUpload(data->capture_time, data->analysis_time, data->routing_time, data->impulse_seq);
+    }
+    void ApplyRouting(std::atomic<float>* g_bandAmplitudes, float dt){
+        float raw[BAND_COUNT], conditioned[BAND_COUNT];
+        for(int i = 0; i < BAND_COUNT; i++) raw[i] = g_bandAmplitudes[i];
+        band_filter.process(raw, conditioned, data->filter, dt);
+
         for(int i = 0; i < BAND_COUNT; i++) {
-            data->audio_bands[i] = (g_bandAmplitudes[i])*data->volume*data->band_volumes[i];
+            data->audio_bands[i] = conditioned[i]*data->volume*data->band_volumes[i];
             
             int routing       = data->audio_routing[i];
             float audio_value = data->audio_bands[i];
@@ -7,6 +7,14 @@
 
 const uint PAGE_LOD = 10;
 
+// Program variants of spell_dodecaplex.frag, drawn while a spell is cast or released
+enum SpellEffect {
+    SPELL_EMPTY,
+    SPELL_CAST_MINING,
+    SPELL_RELEASE_MINING,
+    SPELL_EFFECTS
+};
+
 struct Spell {
     float   click_time      = 0.0f,
             release_time    = 0.0f,
@@ -20,16 +28,16 @@ struct Spell {
                 cast_player_up;
     void (*updateSpellFunction) (PlayerContext*, Spell*);
     void (*startSpellFunction)  (PlayerContext*, Spell*);
-    const char* cast_subroutine;
-    const char* release_subroutine;
+    SpellEffect cast_effect;
+    SpellEffect release_effect;
     Spell() {};
-    Spell(float sd, float cd, char* cs, char* rs,
+    Spell(float sd, float cd, SpellEffect ce, SpellEffect re,
         void (*f1)(PlayerContext*, Spell*), 
         void (*f2)(PlayerContext*, Spell*)) :
             spell_durration(sd), 
             cast_durration(cd), 
-            cast_subroutine(cs),
-            release_subroutine(rs),
+            cast_effect(ce),
+            release_effect(re),
             updateSpellFunction(f1), 
             startSpellFunction(f2) {};
     void reset();
@@ -44,13 +52,13 @@ struct Grimoire {
 
     std::array<Spell, SPELL_COUNT> all_spells = {
         Spell(0.333f, 1.0f, 
-            (char *) "castMining",
-            (char *) "releaseMining",
+            SPELL_CAST_MINING,
+            SPELL_RELEASE_MINING,
             miningSpell,
             emptySpell),
         Spell(0.1f, 0.5f,
-            (char *) "releaseMining",
-            (char *) "releaseMining",
+            SPELL_RELEASE_MINING,
+            SPELL_RELEASE_MINING,
             buildingSpell,
             emptySpell)
     };
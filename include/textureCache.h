@@ -0,0 +1,55 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "workerPool.h"
+
+#define TEXTURE_CACHE_DIR "tmp/textures" // Converted texture arrays, keyed by their images and format
+
+// Texture arrays are decoded, mipmapped and, where the driver offers a block format, compressed once.
+// The result is written here and memory-mapped on later runs, so a load is only the upload.
+// Layout: TextureCacheHeader, levels x uint32_t byte counts, then each level's layers back to back.
+constexpr uint32_t TEXTURE_CACHE_MAGIC   = 0x58544F44; // "DOTX"
+constexpr uint32_t TEXTURE_CACHE_VERSION = 2; // 2: smaller images resampled to the array size
+
+struct TextureCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;   // Internal format: GL_RGBA8 or a compressed one
+    uint32_t width, height, layers, levels;
+};
+
+// Every mip level of an array, in memory or mapped from the cache
+struct TextureArrayImage {
+    GLenum format = GL_RGBA8;
+    int width = 0, height = 0, layers = 0;
+    std::vector<const unsigned char*> levels;
+    std::vector<uint32_t> level_bytes;
+};
+
+struct TextureArrayFile {
+    TextureArrayImage image;
+    void* map = nullptr;
+    size_t mapped_size = 0;
+
+    TextureArrayFile() = default;
+    TextureArrayFile(const TextureArrayFile&) = delete;
+    TextureArrayFile& operator=(const TextureArrayFile&) = delete;
+    ~TextureArrayFile() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+};
+
+GLenum preferredTextureFormat(); // Best block format the driver can compress to, else GL_RGBA8
+std::string textureCachePath(const char* paths[], int count, GLenum format);
+
+// Decodes the images into one RGBA8 array, the first one's size (others are resampled to it),
+// and builds its mip chain, spreading layers over pool. storage owns what image points into.
+bool decodeTextureArray(const std::vector<std::string>& paths, TextureArrayImage& image,
+                        std::vector<std::vector<unsigned char>>& storage, WorkerPool& pool);
+// Has the driver block compress a decoded array, so it needs a current context
+void encodeTextureArray(GLenum format, TextureArrayImage& image, std::vector<std::vector<unsigned char>>& storage);
+bool writeTextureArray(const std::string& path, const TextureArrayImage& image);
@@ -0,0 +1,70 @@
+#pragma once
+#include <glad/glad.h>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "textureCache.h"
+#include "workerPool.h"
+
+#define PBO_RING 3                       // Pixel buffers in flight, each reused once its upload is done
+#define UPLOAD_BYTES_PER_FRAME (8 << 20) // Streamed per poll, though never less than one slice
+#define STREAM_UNIT 15                   // Texture unit arrays are filled on, so drawing bindings stay put
+
+// A texture array on its way to the GPU. id is what is bound to unit: a 1x1 placeholder, or the array
+// loaded before, until the new one is uploaded in full.
+struct StreamedTexture {
+    GLuint id = 0;
+    int unit = 0;
+    bool resident = false;
+};
+
+// Loads texture arrays without holding up the frame. A loader thread maps each converted array from the
+// cache, or decodes its images on a worker pool, and poll() streams what is ready through a ring of pixel
+// buffers a slice (one layer of one level) at a time, swapping an array in once it is complete.
+class TextureStreamer {
+public:
+    TextureStreamer();
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // GL thread. Loading into a texture that is already resident swaps the new array in once it is
+    void load(StreamedTexture* texture, const char* paths[], int count, GLenum format);
+    void poll();   // GL thread, once a frame
+    void finish(); // GL thread, blocks until every requested array is resident
+    bool idle() const { return pending == 0; }
+private:
+    struct Job {
+        StreamedTexture* texture;
+        std::vector<std::string> paths;
+        GLenum format;
+        std::string cache_path;
+        TextureArrayFile cached;
+        TextureArrayImage image;
+        std::vector<std::vector<unsigned char>> storage; // Freshly decoded, when there was no cache
+        bool failed = false;
+        GLuint id = 0;          // Array being filled
+        size_t level = 0;       // Next slice
+        int layer = 0;
+    };
+    void loadLoop();
+    void allocate(Job& job);
+    bool stream(Job& job, size_t& budget); // True once every slice was uploaded
+    void swapIn(Job& job);
+
+    WorkerPool decoders;
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::unique_ptr<Job>> queued, loaded; // Under mutex
+    int pending = 0;                                 // Requested and not resident yet, GL thread
+    bool stopping = false;
+    std::deque<std::unique_ptr<Job>> uploading;      // GL thread
+
+    GLuint pbo[PBO_RING] = {0};
+    GLsizeiptr pbo_size[PBO_RING] = {0};
+    GLsync fence[PBO_RING] = {0};
+    int pbo_next = 0;
+};
@@ -6,34 +6,66 @@
 #include <stb/stb_image.h>
 #include <stdexcept>
 #include <array>
+#include <vector>
+#include "textureStreamer.h"
+#include "bufferObjects.h"
 
+#define MATERIALS_BINDING 2 // Uniform buffer binding of the material table (CameraMatrices 0, ShowParams 1)
+#define MATERIAL_UNIT     0 // Texture unit of the material array, when not bindless
+#define MATERIAL_COUNT    8
+
+// std140 mirror of the Materials block in shaders/materials.glsl
+struct MaterialTable {
+    float materials[MATERIAL_COUNT][4]; // Diffuse layer, specular layer, std140 padding
+};
+
+// Every texture the game draws is one layer of a single array, and materials name layers of it, so
+// world, shrapnel and book draws all sample the one binding and any vertex can pick any material.
 struct TextureLibrary {
+    // Material indices, also in shaders/materials.glsl. Pentagons pick theirs per vertex.
     static const int PENT_COUNT = 4;
-    static const int SPEC_COUNT = 3;
-    static const int BOOK_COUNT = 3;
-    const char* pentagon_paths[PENT_COUNT] = {
+    static const int MATERIAL_SPELL = 4;
+    static const int MATERIAL_GRIMOIRE = 5; // Cover, page, sigil ink
+    static const int LAYER_COUNT = 10;
+
+    // The first image sets the size of the array, the others are resampled to it
+    const char* layer_paths[LAYER_COUNT] = {
         TEXTURE_DIR "/gem.png",
         TEXTURE_DIR "/tile_floor_b.png",
         TEXTURE_DIR "/tile_floor_a.png",
-        TEXTURE_DIR "/test_text.png"
-    };
-    const char* specular_paths[SPEC_COUNT] = {
+        TEXTURE_DIR "/test_text.png",
         TEXTURE_DIR "/curved_spec.png",
         TEXTURE_DIR "/tile_floor_b_disp.png",
-        TEXTURE_DIR "/tile_floor_a.png"
-    };
-    const char* spell_paths[1] = {
-        TEXTURE_DIR "/mining_spell_256.png"
-    };
-    const char* grimoire_paths[BOOK_COUNT] = {
+        TEXTURE_DIR "/mining_spell_256.png",
         TEXTURE_DIR "/grimoire_cover.png",
         TEXTURE_DIR "/grimoire_page_1.png",
         TEXTURE_DIR "/sigil_ink.png"
     };
-    void linkPentagonLibrary(GLuint shaderID);
-    void linkGrimoireLibrary(GLuint shaderID);
-    
-    void readRGBATextureArray(const char* paths[], int num_imgs, int prog_index);
+    const int material_layers[MATERIAL_COUNT][2] = { // Diffuse, specular
+        {0, 4}, {1, 5}, {2, 2}, {3, 2}, // Pentagons
+        {6, 6},                         // Spell
+        {7, 7}, {8, 8}, {9, 9}          // Grimoire
+    };
+    bool compress = true;  // Block compress the array where the driver can
+    bool bindless = false; // Programs sample through a resident handle (ARB_bindless_texture), no unit
+
+    static bool bindlessSupported();
+    // Every program drawing with materials, after any of them was (re)linked. The array is loaded by
+    // the first call and streams in over the next frames, drawn with a placeholder until then.
+    void linkMaterials(const std::vector<GLuint>& program_ids);
+    void update();        // Once a frame, uploads what has been decoded
+    void finishLoading(); // Blocks until the array is resident
+
+private:
+    void loadMaterials();
+    void linkSampler(GLuint program);
+
+    StreamedTexture material_array{0, MATERIAL_UNIT};
+    UBO material_ubo;
+    std::vector<GLuint> programs;
+    GLuint handle_id = 0;  // Texture the resident bindless handle belongs to
+    GLuint64 handle = 0;
+    TextureStreamer streamer;
 };
 
-#endif // TEXTURES_H
\ No newline at end of file
+#endif // TEXTURES_H
@@ -22,6 +22,7 @@ struct Uniforms
 };
 Uniforms* getUniforms(GLFWwindow* window);
 
-GLFWwindow* simplestWindow(unsigned int start_width, unsigned int start_height, const char* title);
+// share: context whose buffers, textures and programs the new one can use
+GLFWwindow* simplestWindow(unsigned int start_width, unsigned int start_height, const char* title, GLFWwindow* share = nullptr);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include <thread>
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+// Small fixed pool that runs a batch of indexed jobs in parallel and waits for all of them.
+// The calling thread takes jobs too, so a pool of 0 threads simply runs the batch inline.
+class WorkerPool {
+public:
+    WorkerPool(int thread_count = 0);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void run(int count, const std::function<void(int)>& job);
+    int size() const { return threads.size(); }
+private:
+    void loop();
+    void drain(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)>* job = nullptr;
+    int total = 0, next = 0, finished = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+};
@@ -35,6 +35,17 @@ private:
     
 };
 
+// The sides of one cell, drawn at whichever detail its size on screen calls for
+struct CellDraw {
+    int cell;
+    std::vector<glm::vec4> corners;   // Of every side drawn, to measure the cell on screen
+    GLsizei first[WEB_DETAILS] = {0}; // Index ranges of its sides at each detail
+    GLsizei count[WEB_DETAILS] = {0};
+    WebDetail detail = WebDetail::FULL_WEB;
+    float distance = 0.0f;            // From the eye, once projected
+    CellDraw(int c) : cell(c) {};
+};
+
 struct PlayerContext {
     PlayerContext();
     ~PlayerContext();
@@ -42,7 +53,12 @@ struct PlayerContext {
     void populateDodecaplexVAO();
     void populateDodecaplexVAO(RhombusPattern web_pattern);
     void populateDodecaplexVAO(RhombusPattern web_pattern, bool include_normals);
+    void shareDodecaplexVAO(const PlayerContext& source); // Draws source's map from the current context
+    void viewCells(glm::mat4 world, glm::mat4 camera, glm::vec2 viewport, float min_px);
+        // Orders the cells front to back under these matrices, and those spanning fewer than min_px
+        // pixels draw plain pentagons (0: none do)
     void drawMainVAO();
+    void drawMainVAO(bool background); // The background quad comes last, behind everything drawn
     void drawShrapnelVAOs();
     void damageOldPentagon(int map_index);
     void footPrints(int map_index);
@@ -62,6 +78,11 @@ private:
     glm::mat4 shrapnel_scatter = glm::mat4(1.0f);
     CPUBufferPair dodecaplex_buffers;
     VAO dodecaplex_vao;
+    bool dodecaplex_normals = false;
+    std::vector<CellDraw> cell_draws;
+    std::vector<int> draw_order;      // Into cell_draws, nearest first
+    std::vector<GLsizei> draw_counts;
+    std::vector<const void*> draw_offsets;
     std::vector<VAO> shrapnel_vaos;
     
     RhombusPattern normal_web   = RhombusPattern(WebType::SIMPLE_STAR, false);
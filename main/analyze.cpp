@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include "audio.h"
+#include "audioFeatures.h"
+
+// Runs the band/onset pipeline over stem files once and writes a feature timeline
+// that spin, fragment and select can play back with --features.
+//   ./analyze set.feat mix.wav bass.wav drums.wav ...
+// The first file becomes channel 0, which feeds the shared audio bands.
+
+struct Stem {
+    ma_decoder decoder;
+    AudioChannel channel;
+    bool finished = false;
+};
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.feat> <stem> [stem ...]\n";
+        return 1;
+    }
+    std::string outPath = argv[1];
+    int stemCount = std::min(argc - 2, MAX_AUDIO_CHANNELS);
+    if (argc - 2 > MAX_AUDIO_CHANNELS) {
+        std::cerr << "Only the first " << MAX_AUDIO_CHANNELS << " stems are analysed.\n";
+    }
+
+    std::vector<std::unique_ptr<Stem>> stems;
+    ma_uint64 longest = 0;
+    for (int s = 0; s < stemCount; ++s) {
+        std::unique_ptr<Stem> stem = std::make_unique<Stem>();
+        ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 1, SAMPLE_RATE);
+        if (ma_decoder_init_file(argv[s + 2], &decoderConfig, &stem->decoder) != MA_SUCCESS) {
+            std::cerr << "Failed to open audio file: " << argv[s + 2] << "\n";
+            for (std::unique_ptr<Stem>& open : stems) ma_decoder_uninit(&open->decoder);
+            return 1;
+        }
+        ma_uint64 length = 0;
+        ma_decoder_get_length_in_pcm_frames(&stem->decoder, &length);
+        longest = std::max(longest, length);
+        stems.push_back(std::move(stem));
+    }
+
+    // Hops are counted as they are read; the decoded length is only a reservation hint.
+    std::vector<float> frames;
+    frames.reserve((longest / FILE_HOP + 1) * stemCount * FEATURE_STRIDE);
+
+    WorkerPool workers(std::min(stemCount, (int)std::thread::hardware_concurrency()) - 1);
+    std::vector<float> hopFeatures(stemCount * FEATURE_STRIDE);
+    auto start_time = std::chrono::steady_clock::now();
+    long hops = 0;
+
+    while (true) {
+        workers.run(stemCount, [&](int s) {
+            Stem& stem = *stems[s];
+            float chunk[FILE_HOP] = {0.0f}; // Finished stems keep feeding silence
+            if (!stem.finished) {
+                ma_uint64 framesRead = 0;
+                ma_decoder_read_pcm_frames(&stem.decoder, chunk, FILE_HOP, &framesRead);
+                if (framesRead < FILE_HOP) stem.finished = true;
+            }
+            stem.channel.writeSamples(chunk, FILE_HOP);
+            stem.channel.processFFT();
+
+            float* out = &hopFeatures[s * FEATURE_STRIDE];
+            for (int b = 0; b < 4; ++b) out[b] = stem.channel.bands[b];
+            out[4] = stem.channel.onset;
+        });
+        frames.insert(frames.end(), hopFeatures.begin(), hopFeatures.end());
+        hops++;
+
+        bool done = std::all_of(stems.begin(), stems.end(),
+                                [](const std::unique_ptr<Stem>& stem) { return stem->finished; });
+        if (done) break;
+    }
+
+    for (std::unique_ptr<Stem>& stem : stems) ma_decoder_uninit(&stem->decoder);
+    if (!writeFeatureFile(outPath, stemCount, FILE_HOP, frames)) return 1;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "Wrote " << hops << " hops x " << stemCount << " stems ("
+              << double(hops) * FILE_HOP / SAMPLE_RATE << "s of audio) to " << outPath
+              << " in " << seconds << "s\n";
+    return 0;
+}
@@ -20,12 +20,15 @@ extern char **environ;
 #include <imgui_impl_opengl3.h>
 #include "imnodes.h"
 #include "graphicsPipe.h"
+#include "rendererHost.h"
 // Project-local
 #include "audio.h"
 #include "sharedUniforms.h"
 #include "config.h"
 #include "attributeSystem.h"
 #include "guiNodes.h"
+#include "presetBank.h"
+#include "paramRecorder.h"
 
 using namespace AttributeHelpers;
 
@@ -38,13 +41,19 @@ ImVec4 bar_colors[BAND_COUNT] = {
 
 // Value generator node color
 ImVec4 value_generator_color = ImVec4(0.8f, 0.2f, 0.8f, 1.0f); // Purple/magenta
+ImVec4 processing_node_color = ImVec4(0.2f, 0.7f, 0.8f, 1.0f); // Teal
 
-// Unified value source manager
-ValueSourceManager valueManager;
+// Preloaded node layouts, and the one being edited and played
+PresetBank presets;
+ValueSourceManager* valueManager = &presets.current();
 
 // Deferred removal system
 std::vector<int> sourcesToRemove;
 
+// Band amplitudes of the extra input channels (channel 0 lives in the shared uniforms)
+float channel_bands[MAX_AUDIO_CHANNELS * BAND_COUNT] = {0.0f};
+BandFilter channel_filters[MAX_AUDIO_CHANNELS];
+
 // Helper function for color conversion
 auto toImU32 = [](const ImVec4& color, int alpha) {
     return IM_COL32((int)(color.x * 255), (int)(color.y * 255), (int)(color.z * 255), alpha);
@@ -65,15 +74,15 @@ std::vector<std::string> ListFragmentShaders(const std::string& directory) {
     return files;
 }
 
-void launch_fragment(const std::string& cmd, int instanceCount) {
+// Spawned without a shell so the group name and shader path reach the renderer verbatim
+void launch_fragment(std::vector<std::string> args, int instanceCount) {
     for (int i = 0; i < instanceCount; ++i) {
         pid_t pid;
-        std::vector<std::string> args = {"/bin/sh", "-c", cmd};
         std::vector<char*> argv;
         for (auto& arg : args) argv.push_back(&arg[0]);
         argv.push_back(nullptr);
 
-        int status = posix_spawn(&pid, "/bin/sh", nullptr, nullptr, argv.data(), environ);
+        int status = posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
         if (status == 0) {
             fragment_pids.push_back(pid);
         } else {
@@ -116,50 +125,29 @@ bool dropDown(const std::vector<T>& options, const char* label, int& selectedInd
 }
 
 // Helper functions for saving/loading ImNodes layout
-void SaveNodeLayoutSlot(int slot) {
-    std::filesystem::create_directories("tmp"); // Ensure tmp/ exists
+void SaveNodeLayoutSlot(int slot, SharedUniforms& uniforms) {
     size_t data_size = 0;
     const char* ini_str = ImNodes::SaveCurrentEditorStateToIniString(&data_size);
-    if (!ini_str || data_size == 0) return;
-    std::string ini_filename = "tmp/nodes_config_slot" + std::to_string(slot) + ".ini";
-    std::ofstream ofs(ini_filename, std::ios::binary);
-    if (ofs) {
-        ofs.write(ini_str, data_size);
-        ofs.close();
-    }
-    // Save node graph as JSON
-    std::string json_filename = "tmp/nodes_config_slot" + std::to_string(slot) + ".json";
-    nlohmann::json j = valueManager.to_json();
-    std::ofstream jfs(json_filename);
-    if (jfs) {
-        jfs << j.dump(2);
-        jfs.close();
-    }
+    std::string ini = ini_str ? std::string(ini_str, data_size) : std::string();
+    if (!presets.save(slot, ini) || slot == presets.currentSlot()) return;
+    // Keep the preloaded copy of the slot in step with its file
+    presets.load(slot, uniforms.data->audio_bands, channel_bands);
 }
 
 void LoadNodeLayoutSlot(int slot, SharedUniforms& uniforms) {
-    // Load node graph from JSON
-    std::string json_filename = "tmp/nodes_config_slot" + std::to_string(slot) + ".json";
-    std::ifstream jfs(json_filename);
-    if (jfs) {
-        nlohmann::json j;
-        jfs >> j;
-        valueManager.from_json(j, uniforms.data->audio_bands);
-        jfs.close();
-    }
-    // Load ImNodes layout
-    std::string ini_filename = "tmp/nodes_config_slot" + std::to_string(slot) + ".ini";
-    std::ifstream ifs(ini_filename, std::ios::binary);
-    if (ifs) {
-        std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-        if (!data.empty()) {
-            ImNodes::LoadCurrentEditorStateFromIniString(data.c_str(), data.size());
-        }
-        ifs.close();
+    // A preloaded slot is faded in; loading the playing slot again reverts it to its file
+    if (slot == presets.currentSlot()) {
+        presets.load(slot, uniforms.data->audio_bands, channel_bands);
+    } else if (!presets.switchTo(slot, uniforms.metadata)) {
+        return;
     }
+    valueManager = &presets.current();
+    const std::string& ini = presets.layout(slot);
+    if (!ini.empty()) ImNodes::LoadCurrentEditorStateFromIniString(ini.c_str(), ini.size());
 }
 
-int main() {
+int main(int argc, char** argv) {
+    CLAs clas = parse(argc, argv);
     GLFWwindow* window = initializeWindow(800, 600, "Select Ritual Mode", false, 0);
 
     glfwMakeContextCurrent(window);
@@ -182,21 +170,43 @@ int main() {
     ImNodes::CreateContext();
     ImNodes::StyleColorsDark();
 
-    SharedUniforms uniforms(true);
+    SharedUniforms uniforms(true, clas.group);
+    const std::string uniforms_group = clas.group; // Passed on to every renderer launched from here
+
+    // Parameter stream recording, replayed by renderers with --replay
+    ParamRecorder recorder;
+    double recordStart = glfwGetTime();
+    std::string recordPath = clas.recordFile.empty() ? "tmp/parameters.rec" : clas.recordFile;
+    if (!clas.recordFile.empty()) recorder.open(recordPath);
 
     GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
     primaryMonitor = 0;
 
     int instanceCount = 1;
+    bool sharedContexts = true; // Launch outputs on render threads of this process instead of new processes
+    RendererHost hosted(window);
     int selectedDeviceIndex = 0;    
 
-    AudioNest audio_nest(selectedDeviceIndex);
+    std::vector<AudioInputConfig> inputConfigs;
+    for (const auto& input : clas.inputs) inputConfigs.push_back({input.first, input.second});
+    if (inputConfigs.empty()) inputConfigs.push_back({selectedDeviceIndex, 1});
+    selectedDeviceIndex = inputConfigs[0].deviceIndex;
+
+    std::unique_ptr<AudioNest> audio_nest;
+    if (!clas.featureFile.empty()) {
+        audio_nest = std::make_unique<AudioNest>(clas.featureFile, clas.audioFile, true);
+    } else if (!clas.audioFile.empty()) {
+        audio_nest = std::make_unique<AudioNest>(clas.audioFile, true);
+    } else {
+        audio_nest = std::make_unique<AudioNest>(inputConfigs);
+    }
+    if (clas.impulseTest) audio_nest->startImpulseTest();
     int previousDeviceIndex = selectedDeviceIndex;
+    int newChannel = 1, newChannelBand = 0;
+    int newNodeKind = 0;
 
-    ma_context context;
-    ma_context_config contextConfig = ma_context_config_init();
-    ma_context_init(NULL, 0, &contextConfig, &context);
-    auto deviceNames = GetInputDeviceNames(&context);
+    std::vector<std::string> deviceNames;
+    if (audio_nest->context_ready) deviceNames = GetInputDeviceNames(&audio_nest->context);
 
     int tabIndex = 0;
 
@@ -206,17 +216,20 @@ int main() {
     // Initialize unified value source system
     // Add audio band sources
     for (int i = 0; i < BAND_COUNT; ++i) {
-        valueManager.addSource(std::make_unique<AudioBandSource>(i, &uniforms.data->audio_bands[i]));
+        valueManager->addSource(std::make_unique<AudioBandSource>(i, &uniforms.data->audio_bands[i]));
     }
     
     // Add initial value generator
-    valueManager.addSource(std::make_unique<MultiModeValueGenerator>());
+    valueManager->addSource(std::make_unique<MultiModeValueGenerator>());
+
+    // Preload the saved slots so switching to one never builds nodes mid-show
+    for (int slot = 1; slot <= PRESET_SLOTS; ++slot) {
+        presets.load(slot, uniforms.data->audio_bands, channel_bands);
+    }
 
     // Time tracking
-    static float lastTime = 0.0f;
-    float currentTime = glfwGetTime();
-    float deltaTime = currentTime - lastTime;
-    lastTime = currentTime;
+    float lastTime = glfwGetTime();
+    float currentTime, deltaTime;
     
    GraphicsPipe* graphicsPipe = nullptr;
 
@@ -227,20 +240,34 @@ int main() {
 
         // Update time
         glfwPollEvents();
+        hosted.poll();
+        currentTime = glfwGetTime();
+        deltaTime = currentTime - lastTime;
+        lastTime = currentTime;
         
         // Update unified value source system
-        valueManager.updateAll(deltaTime);
+        presets.updateAll(deltaTime);
 
         if (previousDeviceIndex != selectedDeviceIndex) {
-            audio_nest.changeAudioDevice(selectedDeviceIndex);
+            audio_nest->changeAudioDevice(selectedDeviceIndex);
             previousDeviceIndex = selectedDeviceIndex;
         }
         // Process audio FFT and update shared uniforms
-        audio_nest.processFFT();
-        uniforms.ApplyRouting(audio_nest.g_bandAmplitudes);
+        audio_nest->processFFT();
+        uniforms.ApplyRouting(audio_nest->g_bandAmplitudes, deltaTime);
+        uniforms.StampLatency(audio_nest->channels[0]->capture_time, audio_nest->channels[0]->analysis_time,
+                              audio_nest->channels[0]->impulses);
+        for (int c = 1; c < audio_nest->channelCount(); ++c) {
+            float raw[BAND_COUNT], conditioned[BAND_COUNT];
+            for (int b = 0; b < BAND_COUNT; ++b) raw[b] = audio_nest->channels[c]->bands[b];
+            channel_filters[c].process(raw, conditioned, uniforms.data->filter, deltaTime);
+            for (int b = 0; b < BAND_COUNT; ++b) {
+                channel_bands[c * BAND_COUNT + b] = conditioned[b] * uniforms.data->volume * uniforms.data->band_volumes[b];
+            }
+        }
         
-        // Apply unified value sources to parameters
-        valueManager.applyToParameters(uniforms.metadata, PARAM_COUNT);
+        // Step the patch graph for this hop, the executor thread evaluates it while the UI is built
+        presets.submitStep(uniforms.metadata, PARAM_COUNT, monotonicSeconds());
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -252,32 +279,57 @@ int main() {
             }
             
             ImGui::InputInt("Instances", &instanceCount);
-            dropDown(deviceNames, "Audio Input", selectedDeviceIndex);
+            ImGui::SameLine();
+            ImGui::Checkbox("Shared Contexts", &sharedContexts);
+            if (hosted.outputCount() > 0) ImGui::Text("%d outputs rendering in this process", hosted.outputCount());
+            ImGui::Text("Group \"%s\": %d renderers connected", uniforms_group.c_str(), uniforms.bus_server.clientCount());
+            if (!recorder.recording() && ImGui::Button("Record Parameters")) {
+                std::filesystem::path recordDir = std::filesystem::path(recordPath).parent_path();
+                if (!recordDir.empty()) std::filesystem::create_directories(recordDir);
+                if (recorder.open(recordPath)) recordStart = glfwGetTime();
+            } else if (recorder.recording() && ImGui::Button("Stop Recording")) {
+                recorder.close();
+            }
+            if (recorder.recording()) {
+                ImGui::SameLine();
+                ImGui::Text("-> %s", recordPath.c_str());
+            }
+            if (!deviceNames.empty()) dropDown(deviceNames, "Audio Input", selectedDeviceIndex);
             
             if (ImGui::Button("Launch Spin")) {
                  CLAs clas;
                 int instancesLeft = instanceCount;
-                if (graphicsPipe == nullptr) {
+                if (sharedContexts) {
+                    clas.audioIndex = selectedDeviceIndex;
+                    clas.group = uniforms_group;
+                    for (; instancesLeft > 0; --instancesLeft) hosted.addOutput(PipeType::SPIN, clas);
+                } else if (graphicsPipe == nullptr) {
                     clas.fullscreen = false;
                     clas.monitorIndex = 0;
                     clas.audioIndex = selectedDeviceIndex;
+                    clas.group = uniforms_group;
                     graphicsPipe = new GraphicsPipe(PipeType::SPIN, clas);
                     graphicsPipe->initHere(window);
+                    graphicsPipe->watchShaders();
                     graphicsPipe->establishShaders();
                     instancesLeft -= 1;
                 }
-                std::stringstream ss;
-                ss << "./spin --input " << selectedDeviceIndex;
-                launch_fragment(ss.str(), instancesLeft);
+                launch_fragment({"./spin", "--input", std::to_string(selectedDeviceIndex), "--group", uniforms_group}, instancesLeft);
             }
 
             dropDown(fragShaders, "Fragment Shader", selectedShaderIndex);
 
             if (ImGui::Button("Launch Fragment")) {
-                std::stringstream ss;
-                ss << "./fragment --input " << selectedDeviceIndex
-                    << " --shader " << FRAG_SHADER_DIR << "/" << fragShaders[selectedShaderIndex].c_str();
-                launch_fragment(ss.str(), instanceCount);
+                if (sharedContexts) {
+                    CLAs clas;
+                    clas.audioIndex = selectedDeviceIndex;
+                    clas.group = uniforms_group;
+                    clas.shaderPath = std::string(FRAG_SHADER_DIR) + "/" + fragShaders[selectedShaderIndex];
+                    for (int i = 0; i < instanceCount; ++i) hosted.addOutput(PipeType::FRAGMENT, clas);
+                } else {
+                    launch_fragment({"./fragment", "--input", std::to_string(selectedDeviceIndex), "--group", uniforms_group,
+                        "--shader", std::string(FRAG_SHADER_DIR) + "/" + fragShaders[selectedShaderIndex]}, instanceCount);
+                }
             }
             
         }
@@ -291,14 +343,14 @@ int main() {
                 if (routed) ImGui::PopStyleColor();
                 if (changed) {
                     // Override any node linking with the value selected
-                    valueManager.removeLink(-1, param_bit); // Remove all links to this parameter
+                    valueManager->removeLink(-1, param_bit); // Remove all links to this parameter
                 }
             };
             
             // Use unified system to check if parameters are driven
             for(int j = 0; j < PARAM_COUNT; j++) {
                 UniformMeta& um = uniforms.metadata[j];
-                bool isDriven = valueManager.isParameterDriven(j);
+                bool isDriven = valueManager->isParameterDriven(j);
                 AddNodeDrivenInput(isDriven, um.name, um.value, um.min, um.max, j);
             }
 
@@ -327,8 +379,23 @@ int main() {
                 ImGui::EndGroup();
             }
             
+            for (int c = 1; c < audio_nest->channelCount(); c++) {
+                ImGui::Text("Channel %d:", c);
+                for (int i = 0; i < BAND_COUNT; i++) {
+                    ImGui::PushStyleColor(ImGuiCol_PlotHistogram, bar_colors[i]);
+                    ImGui::ProgressBar(channel_bands[c * BAND_COUNT + i] / max_amplitude, ImVec2(-1, 6), "");
+                    ImGui::PopStyleColor();
+                }
+            }
+            
             ImGui::Separator();
             ImGui::SliderFloat("Volume", &uniforms.data->volume, 0.0f, 2.0f);
+            ImGui::SliderFloat("Attack", &uniforms.data->filter.attack, 0.001f, 0.5f, "%.3f s");
+            ImGui::SliderFloat("Release", &uniforms.data->filter.release, 0.01f, 2.0f, "%.2f s");
+            ImGui::SliderFloat("Smoothing", &uniforms.data->filter.smoothing, 0.0f, 0.99f);
+            ImGui::SliderFloat("AGC", &uniforms.data->filter.agc_amount, 0.0f, 1.0f);
+            ImGui::SliderFloat("AGC Target", &uniforms.data->filter.agc_target, 0.05f, 2.0f);
+            ImGui::SliderFloat("AGC Time", &uniforms.data->filter.agc_time, 1.0f, 30.0f, "%.1f s");
             
         }
         ImGui::End();
@@ -338,7 +405,34 @@ int main() {
             ImGui::Text("Patch FFT Bands to Parameters");            
             // Add Generator button
             if (ImGui::Button("Add Generator")) {
-                valueManager.addSource(std::make_unique<MultiModeValueGenerator>());
+                valueManager->addSource(std::make_unique<MultiModeValueGenerator>());
+            }
+            if (audio_nest->channelCount() > 1) {
+                // Per-channel bands let separate stems drive separate parameters
+                ImGui::SameLine();
+                if (ImGui::Button("Add Channel Band")) {
+                    valueManager->addSource(std::make_unique<AudioBandSource>(newChannelBand,
+                        &channel_bands[newChannel * BAND_COUNT + newChannelBand], newChannel));
+                }
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(80.0f);
+                ImGui::SliderInt("Channel", &newChannel, 1, audio_nest->channelCount() - 1);
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(80.0f);
+                ImGui::SliderInt("Band", &newChannelBand, 0, BAND_COUNT - 1);
+            }
+            // Processing nodes sit between sources and parameters
+            ImGui::SameLine();
+            if (ImGui::Button("Add Node")) {
+                valueManager->addSource(std::make_unique<ProcessingNode>((ModulationKind)newNodeKind));
+            }
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(120.0f);
+            if (ImGui::BeginCombo("##NodeKind", ProcessingNode::getKindName((ModulationKind)newNodeKind))) {
+                for (int k = 0; k < MODULATION_NODE_KINDS; ++k) {
+                    if (ImGui::Selectable(ProcessingNode::getKindName((ModulationKind)k), k == newNodeKind)) newNodeKind = k;
+                }
+                ImGui::EndCombo();
             }
             
             ImNodes::BeginNodeEditor();
@@ -353,7 +447,7 @@ int main() {
                 float node_spacing = 75.0f;
                 
                 // Position all value sources on the left
-                for (int i = 0; i < valueManager.getSourceCount(); ++i) {
+                for (int i = 0; i < valueManager->getSourceCount(); ++i) {
                     node_positions[i] = ImVec2(left_x, start_y + i * node_spacing);
                 }
                 
@@ -366,16 +460,17 @@ int main() {
                     int col = j % rows;
                     float x = right_x + row * param_spacing_x;
                     float y = start_y + col * param_spacing_y;
-                    node_positions[valueManager.getSourceCount() + j] = ImVec2(x, y);
+                    node_positions[valueManager->getSourceCount() + j] = ImVec2(x, y);
                 }                
             }
             // Output nodes (value sources) - left justified
-            for (int i = 0; i < valueManager.getSourceCount(); ++i) {
-                ValueSource* source = valueManager.getSourceByIndex(i);
+            for (int i = 0; i < valueManager->getSourceCount(); ++i) {
+                ValueSource* source = valueManager->getSourceByIndex(i);
                 if (!source) continue;
                 
-                int s_id = source->getSourceId();
-                ImVec4 sourceColor = (s_id < BAND_COUNT) ? bar_colors[s_id] : value_generator_color;                
+                int band = source->getBandIndex();
+                ProcessingNode* node = dynamic_cast<ProcessingNode*>(source);
+                ImVec4 sourceColor = (band >= 0) ? bar_colors[band] : node ? processing_node_color : value_generator_color;
                 int color_alpha = 50 + (int)(source->getNormalizedValue() * 200);
                 
                 ImU32 bg_color       = toImU32(sourceColor, color_alpha);
@@ -401,19 +496,24 @@ int main() {
                 // Render source-specific UI                
                 source->renderUI();
 
-                // Create output attribute
-                if (source->getSourceId() < BAND_COUNT) {
-                    // Audio band
-                    ImNodes::BeginOutputAttribute(getAudioBandAttributeId(source->getSourceId()));
-                    ImGui::Text("Band %d", source->getSourceId());
-                    ImNodes::EndOutputAttribute();
-                } else {
-                    // Value generator - use unique output attribute ID
-                    int outputAttrId = 2000 + source->getSourceId(); // 2000 + sourceId for unique output
-                    ImNodes::BeginOutputAttribute(outputAttrId);
-                    ImGui::Text("Output");
-                    ImNodes::EndOutputAttribute();
+                if (node) {
+                    for (int in = 0; in < node->getInputCount(); ++in) {
+                        ImNodes::BeginInputAttribute(node->getInputAttributeId(in));
+                        ImGui::Text("%s", node->getInputName(in));
+                        if (node->getInput(in) >= 0) {
+                            ImGui::SameLine();
+                            if (ImGui::SmallButton(("x##in" + std::to_string(node->getInputAttributeId(in))).c_str())) {
+                                valueManager->disconnectInput(node->getSourceId(), in);
+                            }
+                        }
+                        ImNodes::EndInputAttribute();
+                    }
                 }
+
+                // Create output attribute
+                ImNodes::BeginOutputAttribute(source->getOutputAttributeId());
+                ImGui::Text("%s", source->isAudio() ? source->getName().c_str() : "Output");
+                ImNodes::EndOutputAttribute();
                 
                 ImNodes::EndNode();
                 
@@ -426,7 +526,7 @@ int main() {
             // Input nodes (parameters) - right justified
             for (int j = 0; j < PARAM_COUNT; ++j) {
                 ImNodes::BeginNode(getParameterNodeId(j));
-                if (!nodes_initialized) ImNodes::SetNodeScreenSpacePos(getParameterNodeId(j), node_positions[valueManager.getSourceCount() + j]);
+                if (!nodes_initialized) ImNodes::SetNodeScreenSpacePos(getParameterNodeId(j), node_positions[valueManager->getSourceCount() + j]);
                 ImNodes::BeginInputAttribute(getParameterAttributeId(j));
                 ImGui::Text("%s", uniforms.metadata[j].name);                
                 ImNodes::EndInputAttribute();
@@ -435,12 +535,13 @@ int main() {
             // Draw all links with colored splines
             int color_alpha = 100;
             ImVec4 link_color = ImVec4(0.5, 0.5, 0.5, 1.0);
-            for (const auto& link : valueManager.getAllLinks()) {
+            for (const auto& link : valueManager->getAllLinks()) {
                 int sourceId = link.first;
-                ValueSource* source = valueManager.getSource(sourceId);
+                ValueSource* source = valueManager->getSource(sourceId);
                 if (source) {
                     color_alpha = 100 + (int)(source->getNormalizedValue() * 155);
-                    link_color = (sourceId < BAND_COUNT) ? bar_colors[sourceId] : value_generator_color;
+                    int band = source->getBandIndex();
+                    link_color = (band >= 0) ? bar_colors[band] : value_generator_color;
                 }
                 
                 int startAttr, endAttr;
@@ -457,6 +558,20 @@ int main() {
                 ImNodes::PopColorStyle();
                 ImNodes::PopColorStyle();
             }
+            // Links into processing node inputs, ids below zero so they never meet generateLinkId()
+            for (int i = 0; i < valueManager->getSourceCount(); ++i) {
+                ProcessingNode* node = dynamic_cast<ProcessingNode*>(valueManager->getSourceByIndex(i));
+                if (!node) continue;
+                for (int in = 0; in < node->getInputCount(); ++in) {
+                    ValueSource* from = valueManager->getSource(node->getInput(in));
+                    if (!from) continue;
+                    int band = from->getBandIndex();
+                    link_color = (band >= 0) ? bar_colors[band] : value_generator_color;
+                    ImNodes::PushColorStyle(ImNodesCol_Link, toImU32(link_color, 100 + (int)(from->getNormalizedValue() * 155)));
+                    ImNodes::Link(-1 - node->getInputAttributeId(in), from->getOutputAttributeId(), node->getInputAttributeId(in));
+                    ImNodes::PopColorStyle();
+                }
+            }
             nodes_initialized = true;
             
             // Add mini-map for navigation overview
@@ -466,7 +581,7 @@ int main() {
 
             // Handle deferred removals
             for (int sourceId : sourcesToRemove) {
-                valueManager.removeSource(sourceId);
+                valueManager->removeSource(sourceId);
             }
             sourcesToRemove.clear();
 
@@ -474,10 +589,13 @@ int main() {
             int start_attr, end_attr;
             if (ImNodes::IsLinkCreated(&start_attr, &end_attr)) {
                 if (isValidOutputAttribute(start_attr) && isValidInputAttribute(end_attr)) {
-                    int sourceId = valueManager.getSourceIdFromAttribute(start_attr);
-                    int paramIndex = getParameterIndexFromAttributeId(end_attr);
-                    if (sourceId >= 0 && paramIndex >= 0) {
-                        valueManager.addLink(sourceId, paramIndex);
+                    int sourceId = valueManager->getSourceIdFromAttribute(start_attr);
+                    if (sourceId >= 0 && isNodeInputAttribute(end_attr)) {
+                        valueManager->connectInput(sourceId, getNodeFromInputAttributeId(end_attr),
+                                                  getInputFromInputAttributeId(end_attr));
+                    } else if (sourceId >= 0) {
+                        int paramIndex = getParameterIndexFromAttributeId(end_attr);
+                        if (paramIndex >= 0) valueManager->addLink(sourceId, paramIndex);
                     }
                 }
             }
@@ -487,20 +605,30 @@ int main() {
         // Floating Save/Load panel in bottom right
         if (ImGui::Begin("Save/Load Layout")){
             ImGui::Text("Save/Load Layout Slots:");
-            for (int slot = 1; slot <= 3; ++slot) {
+            for (int slot = 1; slot <= PRESET_SLOTS; ++slot) {
                 ImGui::PushID(slot);
                 if (ImGui::Button((std::string("Save ") + std::to_string(slot)).c_str())) {
-                    SaveNodeLayoutSlot(slot);
+                    SaveNodeLayoutSlot(slot, uniforms);
                 }
                 ImGui::SameLine();
                 if (ImGui::Button((std::string("Load ") + std::to_string(slot)).c_str())) {
                     LoadNodeLayoutSlot(slot, uniforms);
                 }
+                ImGui::SameLine();
+                ImGui::Text("%s", slot == presets.currentSlot() ? "playing" : presets.occupied(slot) ? "ready" : "empty");
                 ImGui::PopID();
             }
+            ImGui::SetNextItemWidth(120.0f);
+            ImGui::SliderFloat("Crossfade", &presets.crossfade, 0.0f, 10.0f, "%.1f s");
+            if (presets.fading()) ImGui::ProgressBar(presets.fadeProgress(), ImVec2(120.0f, 0.0f));
         }
         ImGui::End();
 
+        // Hand this frame's parameters to the renderers in one consistent step
+        presets.applyToParameters(uniforms.metadata, &uniforms.data->curves);
+        uniforms.Publish();
+        if (recorder.recording()) recorder.record(glfwGetTime() - recordStart, *uniforms.data);
+
         ImGui::Render();
         int display_w, display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
@@ -514,8 +642,8 @@ int main() {
         glfwSwapBuffers(window);
     }
 
+    hosted.closeAll();
     kill_fragments();
-    ma_context_uninit(&context);
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
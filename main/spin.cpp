@@ -6,10 +6,11 @@ int main(int argc, char** argv) {
     GraphicsPipe pipe(PipeType::SPIN, clas);
     pipe.initWindowed();
 
-    while (!glfwWindowShouldClose(pipe.window)) {
+    while (!glfwWindowShouldClose(pipe.window) && !pipe.benchmarkComplete()) {
         if (pipe.window_uniforms->loading) {
             pipe.establishShaders();
         }
+        pipe.waitForChange();
         pipe.renderNextFrame();
     }
 
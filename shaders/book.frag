@@ -1,12 +1,11 @@
 
-#version 330 core
+#version 410 core
+#include materials.glsl
 
 in vec3 TexCoord; // Input texture coordinate from the vertex shader
 out vec4 FragColor; // Output fragment color
 
-uniform sampler2DArray grimoireTextures; // Texture array
-
 void main() {
-    // Sample the texture at the given texture coordinate and layer 0
-    FragColor = texture(grimoireTextures, TexCoord);
+    // The third coordinate picks the cover, page or ink
+    FragColor = materialDiffuse(TexCoord.xy, MATERIAL_GRIMOIRE + floor(TexCoord.z + 0.5));
 }
\ No newline at end of file
@@ -0,0 +1,4 @@
+#version 410 core
+
+// Depth only: a spell frame's walls are laid down with this first, so the spell shades each pixel once
+void main() {}
@@ -0,0 +1,8 @@
+// Per-output frame values, one upload a frame (mirrored by SpinFrame in graphicsPipe.h). A block rather
+// than plain uniforms, so hosted outputs drawing with one shared program each keep their own.
+layout(std140) uniform SpinFrame {
+    vec2  u_resolution;
+    vec2  u_mouse;
+    float u_scroll;
+    float u_time;
+};
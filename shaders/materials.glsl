@@ -0,0 +1,25 @@
+// Every texture the game draws is a layer of materialTextures, every image resampled to the array size.
+// A material names its diffuse and specular layers (TextureLibrary in textures.h builds the table).
+#ifdef BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+layout(bindless_sampler) uniform sampler2DArray materialTextures;
+#else
+uniform sampler2DArray materialTextures;
+#endif
+
+#define PENTAGON_MATERIALS 4
+#define MATERIAL_SPELL     4
+#define MATERIAL_GRIMOIRE  5
+#define MATERIAL_COUNT     8
+
+layout(std140) uniform Materials {
+    vec4 materials[MATERIAL_COUNT]; // x diffuse layer, y specular layer
+};
+
+vec4 materialDiffuse(vec2 uv, float material) {
+    return texture(materialTextures, vec3(uv, materials[int(material)].x));
+}
+
+vec4 materialSpecular(vec2 uv, float material) {
+    return texture(materialTextures, vec3(uv, materials[int(material)].y));
+}
@@ -0,0 +1,13 @@
+// Show parameters from select, uploaded as a single std140 block (mirrored by ShowParams in graphicsPipe.h)
+layout(std140) uniform ShowParams {
+    vec4  u_audio_bands;
+    float u_scale;
+    float u_brightness;
+    float u_speed;
+    float u_fov;
+    float u_hueShift;
+    float u_vignette;
+    float u_linePx;
+    float u_lineFade;
+    float u_shatter;
+};
@@ -1,7 +1,8 @@
-
 out vec4 mCoords;
 out vec4 wCoords;
 out vec3 tCoords;
+invariant gl_Position; // Computed here; the depth pre-pass and the spell pass must agree on it
+
 
 #define FOCUS sqrt(5)
 
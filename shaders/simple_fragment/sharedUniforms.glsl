@@ -1,6 +1 @@
-uniform float u_scale;
-uniform float u_brightness;
-uniform float u_speed;
-uniform float u_fov;
-uniform float u_hueShift;
-uniform float u_vignette;
\ No newline at end of file
+#include ../params.glsl
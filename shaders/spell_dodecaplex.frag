@@ -1,12 +1,10 @@
 #version 410 core
+#include materials.glsl
 
 in float zDepth;
 in vec4 model_Coords;
 in vec3 texture_Coords;
 
-uniform sampler2DArray pentagonTextures;
-uniform sampler2DArray specularTextures;
-uniform sampler2DArray spellTextures;
 uniform float u_time;
 uniform vec2 u_resolution;
 uniform float SPELL_LIFE;
@@ -17,13 +15,9 @@ uniform vec3 SPELL_FOCUS;
 out vec4 color;
 
 
-subroutine vec4 spell (vec4 color);
-subroutine uniform spell currentSpell;
-
-subroutine (spell) vec4 emptySpell(vec4 color) {
-    return color;
-}
-subroutine (spell) vec4 castMining(vec4 color) {
+// One program variant per SpellEffect (spells.h), the empty one draws only the walls
+#if defined(SPELL_CAST_MINING)
+vec4 currentSpell(vec4 color) {
     float cast_life  = pow(CAST_LIFE*.95, 1.5); 
     float s_time     = u_time*5;
     float c_time     = u_time/5;
@@ -31,7 +25,7 @@ subroutine (spell) vec4 castMining(vec4 color) {
 
     vec2 window      = (gl_FragCoord.xy-(u_resolution/2.0))/(max(u_resolution.x, u_resolution.y));
     float wall_dist  = length(cross(SPELL_FOCUS, SPELL_HEAD-model_Coords.xyz))*0.5;
-    vec4 spec_data   = max(texture(specularTextures, texture_Coords), 0.5 );
+    vec4 spec_data   = max(materialSpecular(texture_Coords.xy, clamp(floor(texture_Coords.z + 0.5), 0.0, PENTAGON_MATERIALS - 1.0)), 0.5 );
     
     float angle      = atan(window.x, window.y)+sin(u_time)*10.0;
     float radius     = pow(length(window*4.0)*(1.0+(zDepth))/cast_life/5., .5);
@@ -50,7 +44,7 @@ subroutine (spell) vec4 castMining(vec4 color) {
     vec4 perif_lighting = vec4(0);
     for (int i=2; i < 7; i++) {
          perif_lighting = max(perif_lighting, 
-                texture(spellTextures, vec3(pow(-1.0, i)*sin(pow(s_time,i*.3333))*window[i%2], cos(pow(s_time,i*.3333))*window[i%2+1],1.0f))
+                materialDiffuse(vec2(pow(-1.0, i)*sin(pow(s_time,i*.3333))*window[i%2], cos(pow(s_time,i*.3333))*window[i%2+1]), MATERIAL_SPELL)
          );
     }   
          perif_lighting /= 2*length(rit_wind);
@@ -58,9 +52,9 @@ subroutine (spell) vec4 castMining(vec4 color) {
 
     vec2 norm_window =rit_wind*3+vec2(0.5);
 
-    vec4 cent_lighting =        texture(spellTextures, vec3((norm_window*rit_mat).yx, 1.0f));
-         cent_lighting += pow(  texture(spellTextures, vec3(norm_window,         1.0f)), vec4(10.0));
-         cent_lighting +=       texture(spellTextures, vec3(rit_mat*norm_window, 1.0f));
+    vec4 cent_lighting =        materialDiffuse((norm_window*rit_mat).yx, MATERIAL_SPELL);
+         cent_lighting += pow(  materialDiffuse(norm_window, MATERIAL_SPELL), vec4(10.0));
+         cent_lighting +=       materialDiffuse(rit_mat*norm_window, MATERIAL_SPELL);
          cent_lighting = mix(cent_lighting, pow(perif_lighting, vec4(0.2, 0.2, 0.3, 1.0)), log(perif_lighting+1))*pow(cast_life, 1.4);
          cent_lighting = mix(spec_lit, pow(cent_lighting, vec4(10.0)), -pow(spec_data, vec4(2.0)));
          cent_lighting = pow(cent_lighting, vec4(.7));
@@ -70,7 +64,8 @@ subroutine (spell) vec4 castMining(vec4 color) {
                 pow(cent_lighting, vec4(2.0)), 
                 pow(cent_lighting*vec4(.2, .3+.1*sin(s_time), .6, 1.0), vec4(10.0)));
 }
-subroutine (spell) vec4 releaseMining(vec4 color) {
+#elif defined(SPELL_RELEASE_MINING)
+vec4 currentSpell(vec4 color) {
     float wall_dist = length(cross(SPELL_FOCUS, SPELL_HEAD-model_Coords.xyz));
     return mix(color,
             mix(color, 
@@ -80,12 +75,17 @@ subroutine (spell) vec4 releaseMining(vec4 color) {
             clamp(0.01, 1.0, pow(SPELL_LIFE, -2.0)/wall_dist)),            
             1.0/wall_dist);
 }
+#else
+vec4 currentSpell(vec4 color) {
+    return color;
+}
+#endif
 
 void main(){
     float remainder = texture_Coords.z- floor(texture_Coords.z);
     vec4 v1, v2;
-    v1 = texture(pentagonTextures, vec3(texture_Coords.xy, ceil(texture_Coords.z)));
-    v2 = texture(pentagonTextures, vec3(texture_Coords.xy, floor(texture_Coords.z)));
+    v1 = materialDiffuse(texture_Coords.xy, clamp(ceil(texture_Coords.z),  0.0, PENTAGON_MATERIALS - 1.0));
+    v2 = materialDiffuse(texture_Coords.xy, clamp(floor(texture_Coords.z), 0.0, PENTAGON_MATERIALS - 1.0));
     color = mix(v1, v2, pow(remainder, 2));
     color = mix(color, mix(v1, v2, 1-pow(remainder, 3)), 1-remainder);
     color /= max(zDepth*1.5, 1.0);
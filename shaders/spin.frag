@@ -6,15 +6,8 @@ in vec3 texture_Coords;
 in vec3 bary_Coords;
 flat in vec2 wP0, wP1, wP2;
 
-uniform float u_time;
-uniform float u_scale;
-uniform vec2 u_resolution;
-uniform vec4 u_audio_bands;
-uniform float u_brightness;
-uniform float u_hueShift;
-uniform float u_vignette;
-uniform float u_linePx;
-uniform float u_lineFade;
+#include params.glsl
+#include frame.glsl
 #include hueRotation.glsl
 
 out vec4 color;
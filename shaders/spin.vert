@@ -6,9 +6,8 @@ layout(location = 2) in vec4 model_normals;
 
 #include projection.glsl
 
- uniform vec4 u_audio_bands;
- uniform float u_time;
- uniform float u_shatter;
+#include params.glsl
+#include frame.glsl
 
 vec4 addTextureToNormal(vec2 tex, vec4 normal) {
     // Step 1: normalize the input normal
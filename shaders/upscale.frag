@@ -0,0 +1,44 @@
+#version 330 core
+layout (location = 0) out vec4 fragColor;
+
+uniform sampler2D u_frame;    // Scaled render, in the lower left of a window sized texture
+uniform sampler2D u_history;  // Previous upscaled frame
+uniform vec2 u_extent;        // Fraction of u_frame the render covers
+uniform vec2 u_texel;         // One texel of u_frame
+uniform vec2 u_resolution;
+uniform float u_sharpness;
+uniform float u_feedback;
+
+// Bilinear taps stay half a texel inside the render, so the unused part of the target never bleeds in
+vec3 tap(vec2 at) {
+    return texture(u_frame, clamp(at, 0.5 * u_texel, u_extent - 0.5 * u_texel)).rgb;
+}
+
+void main() {
+    vec2 uv = gl_FragCoord.xy / u_resolution;
+    vec2 at = uv * u_extent;
+    vec3 color = tap(at);
+
+#if defined(SHARPEN) || defined(TEMPORAL)
+    // Neighbours one rendered pixel away
+    vec3 n = tap(at + vec2(0.0, u_texel.y));
+    vec3 s = tap(at - vec2(0.0, u_texel.y));
+    vec3 e = tap(at + vec2(u_texel.x, 0.0));
+    vec3 w = tap(at - vec2(u_texel.x, 0.0));
+    vec3 lo = min(color, min(min(n, s), min(e, w)));
+    vec3 hi = max(color, max(max(n, s), max(e, w)));
+#endif
+
+#ifdef SHARPEN
+    color = clamp(color + u_sharpness * (color - 0.25 * (n + s + e + w)), lo, hi);
+#endif
+
+#ifdef TEMPORAL
+    // Screen space art has no motion vectors, so the history is reprojected in place and clamped to
+    // the current neighbourhood, which keeps anything that moved from ghosting
+    vec3 history = clamp(texture(u_history, uv).rgb, lo, hi);
+    color = mix(color, history, u_feedback);
+#endif
+
+    fragColor = vec4(color, 1.0);
+}
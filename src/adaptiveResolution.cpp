@@ -0,0 +1,141 @@
+#include <cmath>
+#include <algorithm>
+#include "adaptiveResolution.h"
+
+void AdaptiveResolution::init(const ResolutionSettings& s) {
+    settings = s;
+    current_scale = settings.fixed_scale > 0.0f ? std::min(settings.fixed_scale, 1.0f) : 1.0f;
+
+    upscale_shader = ShaderProgram(FRAG_SHADER_DIR "/rect.vert", SHADER_DIR "/upscale.frag", false);
+    if (settings.filter == UpscaleFilter::SHARPEN) upscale_shader.defines.push_back("SHARPEN");
+    if (settings.temporal) upscale_shader.defines.push_back("TEMPORAL");
+    upscale_shader.Load();
+    locate();
+    quad = rasterPipeVAO();
+
+    glGenFramebuffers(1, &frame_fbo);
+    glGenTextures(1, &frame_texture);
+    glGenFramebuffers(2, history_fbo);
+    glGenTextures(2, history_texture);
+    glGenQueries(GPU_TIMER_QUERIES, queries);
+}
+
+void AdaptiveResolution::locate() {
+    U_FRAME      = glGetUniformLocation(upscale_shader.ID, "u_frame");
+    U_HISTORY    = glGetUniformLocation(upscale_shader.ID, "u_history");
+    U_EXTENT     = glGetUniformLocation(upscale_shader.ID, "u_extent");
+    U_TEXEL      = glGetUniformLocation(upscale_shader.ID, "u_texel");
+    U_RESOLUTION = glGetUniformLocation(upscale_shader.ID, "u_resolution");
+    U_SHARPNESS  = glGetUniformLocation(upscale_shader.ID, "u_sharpness");
+    U_FEEDBACK   = glGetUniformLocation(upscale_shader.ID, "u_feedback");
+}
+
+static void allocateTarget(GLuint fbo, GLuint texture, GLenum format, int width, int height) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Incomplete framebuffer for a " << width << "x" << height << " render target" << std::endl;
+    }
+}
+
+void AdaptiveResolution::allocate(int w, int h) {
+    width = w;
+    height = h;
+    allocateTarget(frame_fbo, frame_texture, GL_RGBA8, width, height);
+    if (settings.temporal) {
+        // Half floats, so the feedback does not band dark gradients
+        allocateTarget(history_fbo[0], history_texture[0], GL_RGBA16F, width, height);
+        allocateTarget(history_fbo[1], history_texture[1], GL_RGBA16F, width, height);
+    }
+    history_valid = false;
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void AdaptiveResolution::readTimers() {
+    // The slot about to be reused was issued GPU_TIMER_QUERIES frames ago; if the driver is still
+    // behind, that sample is dropped rather than waited for
+    if (!query_issued[query_head]) return;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[query_head], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(queries[query_head], GL_QUERY_RESULT, &elapsed);
+
+    // Fragment cost follows the pixel count, the square of the scale the sample was taken at
+    float timed_scale = query_scale[query_head];
+    float ms = 1e-6f * elapsed / (timed_scale * timed_scale);
+    full_ms = full_ms > 0.0f ? full_ms + 0.1f * (ms - full_ms) : ms;
+
+    float budget = RESOLUTION_HEADROOM * 1000.0f / settings.target_fps;
+    float ideal = std::clamp(sqrtf(budget / full_ms), MIN_RENDER_SCALE, 1.0f);
+    if (fabsf(ideal - current_scale) > RESOLUTION_DEADBAND * current_scale) {
+        current_scale += 0.5f * (ideal - current_scale);
+    }
+}
+
+void AdaptiveResolution::begin(int w, int h) {
+    w = std::max(w, 1);
+    h = std::max(h, 1);
+    if (w != width || h != height) allocate(w, h);
+
+    bool adaptive = settings.fixed_scale <= 0.0f;
+    if (adaptive) {
+        readTimers();
+        query_scale[query_head] = current_scale;
+        glBeginQuery(GL_TIME_ELAPSED, queries[query_head]);
+    }
+    renderWidth  = std::max(1, (int)(width  * current_scale + 0.5f));
+    renderHeight = std::max(1, (int)(height * current_scale + 0.5f));
+
+    glBindFramebuffer(GL_FRAMEBUFFER, frame_fbo);
+    glViewport(0, 0, renderWidth, renderHeight);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void AdaptiveResolution::end() {
+    if (settings.fixed_scale <= 0.0f) {
+        glEndQuery(GL_TIME_ELAPSED);
+        query_issued[query_head] = true;
+        query_head = (query_head + 1) % GPU_TIMER_QUERIES;
+    }
+
+    // With temporal blending the result also becomes the next frame's history
+    GLuint target = settings.temporal ? history_fbo[history_index] : 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+
+    upscale_shader.Activate();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, frame_texture);
+    glUniform1i(U_FRAME, 0);
+    if (settings.temporal) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, history_texture[1 - history_index]);
+        glUniform1i(U_HISTORY, 1);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glUniform2f(U_EXTENT,     (float)renderWidth / width, (float)renderHeight / height);
+    glUniform2f(U_TEXEL,      1.0f / width, 1.0f / height);
+    glUniform2f(U_RESOLUTION, width, height);
+    glUniform1f(U_SHARPNESS,  UPSCALE_SHARPNESS);
+    glUniform1f(U_FEEDBACK,   history_valid && current_scale < 1.0f ? TEMPORAL_FEEDBACK : 0.0f);
+    quad.DrawElements(GL_TRIANGLES);
+
+    if (settings.temporal) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, history_fbo[history_index]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        history_index = 1 - history_index;
+        history_valid = true;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+}
@@ -1,11 +1,11 @@
 #include <iostream>
 #include <complex>
 #include <cstdio>
+#include <chrono>
+#include <algorithm>
 #define MINIAUDIO_IMPLEMENTATION
 #include "audio.h"
 
-std::array<float, BUFFER_SIZE> AudioNest::g_audioBuffer = {};
-
 ma_device_id select_input_device(ma_context* context) {
     ma_device_info* pPlaybackInfos;
     ma_uint32 playbackCount;
@@ -53,12 +53,31 @@ void fft(std::vector<std::complex<float>>& data) {
     }
 }
 
+void AudioChannel::writeSamples(const float* in, ma_uint32 frameCount, int stride) {
+    double now = monotonicSeconds();
+    for (ma_uint32 i = 0; i < frameCount; ++i) {
+        float sample = in[i * stride];
+        if (impulse_period > 0) {
+            sample = 0.0f;
+            if (--impulse_countdown <= 0) {
+                sample = 1.0f;
+                impulse_countdown = impulse_period;
+                impulse_time = now;
+                impulse_pending = true;
+            }
+        }
+        buffer[writeHead] = sample;
+        writeHead = (writeHead + 1) % BUFFER_SIZE;
+    }
+    last_write = now;
+}
+
 // Main function to process FFT and extract 4 bands
-void AudioNest::processFFT() {
+void AudioChannel::processFFT() {
     size_t N = BUFFER_SIZE;
     std::vector<std::complex<float>> data(N);
     for (size_t i = 0; i < N; ++i) {
-        data[i] = std::complex<float>(g_audioBuffer[i], 0.0f);
+        data[i] = std::complex<float>(buffer[i], 0.0f);
     }
 
     fft(data); // In-place
@@ -77,7 +96,8 @@ void AudioNest::processFFT() {
         if (bandIndices[i] >= N / 2) bandIndices[i] = N / 2 - 1;
     }
 
-    // Compute average magnitude per band
+    // Compute average magnitude per band, and the onset strength as the rise in band energy
+    float flux = 0.0f;
     for (int b = 0; b < 4; ++b) {
         float sum = 0.0f;
         size_t start = bandIndices[b];
@@ -85,8 +105,47 @@ void AudioNest::processFFT() {
         for (size_t i = start; i < end; ++i) {
             sum += magnitudes[i];
         }
-        g_bandAmplitudes[b] = (end > start) ? (sum / (end - start)) : 0.0f;
+        float band = (end > start) ? (sum / (end - start)) : 0.0f;
+        flux += std::max(0.0f, band - previous[b]);
+        previous[b] = band;
+        bands[b] = band;
+    }
+    onset = flux;
+
+    capture_time = last_write;
+    if (impulse_pending && bands[0] > IMPULSE_THRESHOLD) {
+        capture_time = impulse_time;
+        impulse_pending = false;
+        impulses++;
+    }
+    analysis_time = monotonicSeconds();
+}
+
+void AudioNest::processFFT() {
+    auto start_time = std::chrono::steady_clock::now();
+    if (features.loaded()) {
+        // Pre-analysed: a lookup per channel replaces the FFTs
+        uint64_t hop = currentHop();
+        for (int c = 0; c < channelCount(); ++c) {
+            const float* frame = features.frame(hop, c);
+            for (int b = 0; b < 4; ++b) channels[c]->bands[b] = frame[b];
+            channels[c]->onset = frame[4];
+        }
+        analysis_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        analysis_hops++;
+        return;
+    }
+    if (!filePath.empty() && !realtime) {
+        readFileSamples(FILE_HOP);
     }
+
+    // Each channel's FFT is independent, so they are spread over the worker pool.
+    workers.run(channelCount(), [this](int c) {
+        channels[c]->processFFT();
+    });
+
+    analysis_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    analysis_hops++;
 }
 
 std::vector<std::string> GetInputDeviceNames(ma_context* context) {
@@ -106,13 +165,123 @@ std::vector<std::string> GetInputDeviceNames(ma_context* context) {
     return names;
 }
 
-void AudioNest::startAudioDevice(){
-    ma_result result = ma_context_init(NULL, 0, NULL, &context);
-    if (result != MA_SUCCESS) {
+int countChannels(const std::vector<AudioInputConfig>& configs) {
+    int total = 0;
+    for (const AudioInputConfig& config : configs) total += config.channels;
+    return std::min(std::max(total, 1), MAX_AUDIO_CHANNELS);
+}
+
+int poolSize(int channel_count) {
+    // The calling thread analyses one channel itself.
+    int hardware = std::max(1, (int)std::thread::hardware_concurrency());
+    return std::min(channel_count, hardware) - 1;
+}
+
+AudioNest::AudioNest(const std::vector<AudioInputConfig>& configs)
+        : deviceIndex(configs.empty() ? 0 : configs[0].deviceIndex),
+          workers(poolSize(countChannels(configs))) {
+    allocateChannels(countChannels(configs));
+    initContext();
+    if (!context_ready) return;
+
+    int firstChannel = 0;
+    for (const AudioInputConfig& config : configs) {
+        int count = std::min(config.channels, channelCount() - firstChannel);
+        if (count <= 0) break;
+        std::unique_ptr<AudioInput> input = openInput(config.deviceIndex, firstChannel, count);
+        if (input) inputs.push_back(std::move(input));
+        firstChannel += count;
+    }
+}
+
+AudioNest::AudioNest(const std::string& path, bool rt)
+        : deviceIndex(-1), workers(0), filePath(path), realtime(rt) {
+    allocateChannels(1);
+    startAudioFile();
+}
+
+AudioNest::AudioNest(const std::string& featurePath, const std::string& audioPath, bool rt)
+        : deviceIndex(-1), workers(0), filePath(audioPath), realtime(rt) {
+    if (!features.open(featurePath)) {
+        // Fall back to analysing the audio live
+        allocateChannels(1);
+        if (!filePath.empty()) startAudioFile();
+        return;
+    }
+    allocateChannels(std::min(features.stems(), MAX_AUDIO_CHANNELS));
+    feature_start = std::chrono::steady_clock::now();
+    if (!filePath.empty() && realtime) startPlayback();
+}
+
+uint64_t AudioNest::currentHop() const {
+    // Seconds into the set: played frames when audible, the frame clock offline, wall time otherwise
+    double seconds;
+    if (playing) {
+        seconds = double(played_frames.load()) / SAMPLE_RATE;
+    } else if (!realtime) {
+        seconds = double(analysis_hops) * FILE_HOP / SAMPLE_RATE;
+    } else {
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - feature_start).count();
+    }
+    return (uint64_t)(seconds * features.header->sampleRate / features.header->hop);
+}
+
+void AudioNest::startPlayback() {
+    if (!openDecoder()) return;
+    initContext();
+    if (!context_ready) return;
+
+    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
+    deviceConfig.playback.format   = ma_format_f32;
+    deviceConfig.playback.channels = 1;
+    deviceConfig.sampleRate        = SAMPLE_RATE;
+    deviceConfig.dataCallback      = AudioNest::playback_callback;
+    deviceConfig.pUserData         = this;
+
+    if (ma_device_init(&context, &deviceConfig, &playback) != MA_SUCCESS) {
+        std::cerr << "Failed to initialize playback device, features follow the wall clock.\n";
+        return;
+    }
+    playing = true;
+    ma_device_start(&playback);
+}
+
+void AudioNest::playback_callback(ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
+    AudioNest* nest = (AudioNest*)device->pUserData;
+    float* out = (float*)output;
+    ma_uint32 written = 0;
+    while (written < frameCount) {
+        ma_uint64 framesRead = 0;
+        ma_decoder_read_pcm_frames(&nest->decoder, out + written, frameCount - written, &framesRead);
+        if (framesRead == 0) {
+            // Loop, like the timeline does
+            if (ma_decoder_seek_to_pcm_frame(&nest->decoder, 0) != MA_SUCCESS) break;
+            ma_decoder_read_pcm_frames(&nest->decoder, out + written, frameCount - written, &framesRead);
+            if (framesRead == 0) break;
+        }
+        written += (ma_uint32)framesRead;
+    }
+    nest->played_frames += frameCount;
+}
+
+void AudioNest::allocateChannels(int count) {
+    for (int c = 0; c < count; ++c) {
+        channels.push_back(std::make_unique<AudioChannel>());
+        channel_ptrs.push_back(channels.back().get());
+    }
+    g_bandAmplitudes = channels[0]->bands;
+}
+
+void AudioNest::initContext() {
+    // The context lives as long as the nest, so switching devices never re-enumerates backends.
+    if (ma_context_init(NULL, 0, NULL, &context) != MA_SUCCESS) {
         std::cerr << "Failed to initialize miniaudio context.\n";
         return;
     }
+    context_ready = true;
+}
 
+std::unique_ptr<AudioInput> AudioNest::openInput(int index, int firstChannel, int count, bool live) {
     ma_device_info* pPlaybackInfos;
     ma_uint32 playbackCount;
     ma_device_info* pCaptureInfos;
@@ -121,33 +290,126 @@ void AudioNest::startAudioDevice(){
     if (ma_context_get_devices(&context, &pPlaybackInfos, &playbackCount,
                             &pCaptureInfos, &captureCount) != MA_SUCCESS) {
         std::cerr << "Failed to enumerate audio devices.\n";
-        return;
+        return nullptr;
+    }
+    if (index < 0 || index >= (int)captureCount) {
+        std::cerr << "No audio input device " << index << ".\n";
+        return nullptr;
     }
 
-    ma_device_id selectedInputDevice = pCaptureInfos[deviceIndex].id;
+    std::unique_ptr<AudioInput> input = std::make_unique<AudioInput>();
+    input->deviceIndex  = index;
+    input->channelCount = count;
+    input->targets      = &channel_ptrs[firstChannel];
+    input->live         = live;
 
+    ma_device_id selectedInputDevice = pCaptureInfos[index].id;
     ma_device_config deviceConfig = ma_device_config_init(ma_device_type_capture);
     deviceConfig.capture.pDeviceID = &selectedInputDevice;
     deviceConfig.capture.format   = ma_format_f32;
-    deviceConfig.capture.channels = 1;
+    deviceConfig.capture.channels = count;
     deviceConfig.sampleRate       = SAMPLE_RATE;
-    deviceConfig.dataCallback     = AudioNest::data_callback;
+    deviceConfig.dataCallback     = AudioInput::data_callback;
+    deviceConfig.pUserData        = input.get();
 
-    if (ma_device_init(&context, &deviceConfig, &device) != MA_SUCCESS) {
+    if (ma_device_init(&context, &deviceConfig, &input->device) != MA_SUCCESS) {
         std::cerr << "Failed to initialize audio device.\n";
-        return;
+        return nullptr;
     }
-    ma_device_start(&device);    
-};
+    ma_device_start(&input->device);
+    return input;
+}
+
+void AudioNest::closeInput(AudioInput& input) {
+    ma_device_stop(&input.device);
+    ma_device_uninit(&input.device);
+}
 
 void AudioNest::changeAudioDevice(int index) {
-    // Stop the current device
-    ma_device_stop(&device);
-    ma_device_uninit(&device);
-    
-    // Update the device index
-    deviceIndex = index;
-    
-    // Restart with the new device
-    startAudioDevice();
+    changeAudioDevice(0, index);
+}
+
+void AudioNest::changeAudioDevice(int input, int index) {
+    if (!filePath.empty() || input < 0 || input >= (int)inputs.size()) return;
+
+    // The replacement is opened and running before the old device stops, so its slow start-up never
+    // leaves a gap. It only writes into the shared ring buffers once the old callback can no longer
+    // run (ma_device_stop waits for it), so the two streams are never interleaved.
+    AudioInput& old = *inputs[input];
+    int firstChannel = old.targets - channel_ptrs.data();
+    std::unique_ptr<AudioInput> replacement = openInput(index, firstChannel, old.channelCount, false);
+    if (!replacement) return;
+
+    closeInput(old);
+    replacement->live.store(true, std::memory_order_release);
+    inputs[input] = std::move(replacement);
+    if (input == 0) deviceIndex = index;
+}
+
+void AudioNest::startImpulseTest(int period) {
+    if (features.loaded()) {
+        std::cerr << "Impulse test needs live analysis, ignored with a feature timeline.\n";
+        return;
+    }
+    for (std::unique_ptr<AudioChannel>& channel : channels) {
+        channel->impulse_countdown = period;
+        channel->impulse_period    = period;
+    }
+}
+
+bool AudioNest::openDecoder() {
+    ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, 1, SAMPLE_RATE);
+    if (ma_decoder_init_file(filePath.c_str(), &decoderConfig, &decoder) != MA_SUCCESS) {
+        std::cerr << "Failed to open audio file: " << filePath << "\n";
+        filePath.clear();
+        return false;
+    }
+    decoder_ready = true;
+    return true;
+}
+
+void AudioNest::startAudioFile() {
+    if (!openDecoder()) return;
+    if (realtime) {
+        streaming = true;
+        file_thread = std::thread(&AudioNest::streamFile, this);
+    }
+}
+
+void AudioNest::readFileSamples(ma_uint32 frameCount) {
+    // Pulls frameCount mono samples into the analysis buffer, looping at the end of the file.
+    float chunk[FILE_HOP > FILE_CHUNK ? FILE_HOP : FILE_CHUNK];
+    ma_uint32 remaining = frameCount;
+    while (remaining > 0) {
+        ma_uint64 framesRead = 0;
+        ma_decoder_read_pcm_frames(&decoder, chunk, remaining, &framesRead);
+        if (framesRead == 0) {
+            ma_decoder_seek_to_pcm_frame(&decoder, 0);
+            ma_decoder_read_pcm_frames(&decoder, chunk, remaining, &framesRead);
+            if (framesRead == 0) return; // Empty file
+        }
+        channels[0]->writeSamples(chunk, (ma_uint32)framesRead);
+        remaining -= (ma_uint32)framesRead;
+    }
+}
+
+void AudioNest::streamFile() {
+    // Feeds the decoder at the device rate, standing in for the capture callback.
+    auto tick = std::chrono::duration<double>(double(FILE_CHUNK) / SAMPLE_RATE);
+    auto next = std::chrono::steady_clock::now();
+    while (streaming) {
+        readFileSamples(FILE_CHUNK);
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(tick);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+AudioNest::~AudioNest() {
+    for (std::unique_ptr<AudioInput>& input : inputs) closeInput(*input);
+    if (playing) ma_device_uninit(&playback);
+    if (context_ready) ma_context_uninit(&context);
+
+    streaming = false;
+    if (file_thread.joinable()) file_thread.join();
+    if (decoder_ready) ma_decoder_uninit(&decoder);
 }
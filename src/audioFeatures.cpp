@@ -0,0 +1,74 @@
+#include <iostream>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "audioFeatures.h"
+#include "audio.h"
+
+bool FeatureTimeline::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Failed to open feature file: " << path << "\n";
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(FeatureHeader)) {
+        std::cerr << "Feature file too small: " << path << "\n";
+        ::close(fd);
+        return false;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map feature file: " << path << "\n";
+        return false;
+    }
+
+    const FeatureHeader* h = (const FeatureHeader*)map;
+    size_t expected = sizeof(FeatureHeader) + h->hops * h->stems * h->stride * sizeof(float);
+    if (h->magic != FEATURE_MAGIC || h->version != FEATURE_VERSION || h->stride < FEATURE_STRIDE
+        || h->stems == 0 || h->hops == 0 || h->hop == 0 || (size_t)info.st_size < expected) {
+        std::cerr << "Invalid feature file: " << path << "\n";
+        munmap(map, info.st_size);
+        return false;
+    }
+    if (h->sampleRate != SAMPLE_RATE) {
+        std::cerr << "Feature file analysed at " << h->sampleRate << "Hz, timing is scaled to match.\n";
+    }
+
+    header      = h;
+    frames      = (const float*)(h + 1);
+    mapped_size = info.st_size;
+    return true;
+}
+
+void FeatureTimeline::close() {
+    if (!header) return;
+    munmap((void*)header, mapped_size);
+    header = nullptr;
+    frames = nullptr;
+    mapped_size = 0;
+}
+
+bool writeFeatureFile(const std::string& path, uint32_t stems, uint32_t hop, const std::vector<float>& frames) {
+    FeatureHeader header;
+    header.magic      = FEATURE_MAGIC;
+    header.version    = FEATURE_VERSION;
+    header.stems      = stems;
+    header.stride     = FEATURE_STRIDE;
+    header.hop        = hop;
+    header.sampleRate = SAMPLE_RATE;
+    header.hops       = frames.size() / (stems * FEATURE_STRIDE);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to write feature file: " << path << "\n";
+        return false;
+    }
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)frames.data(), header.hops * stems * FEATURE_STRIDE * sizeof(float));
+    return (bool)out;
+}
@@ -49,12 +49,17 @@ void EBO::Delete()  { glDeleteBuffers(1, &ID); }
 
 // Uniform Buffer Object
 UBO::UBO() {}
-UBO::UBO(GLfloat* vertices, GLsizeiptr size) {
+UBO::UBO(GLfloat* vertices, GLsizeiptr size, GLenum usage) : vertices(vertices), size(size) {
 	glGenBuffers(1, &ID);
 	glBindBuffer(GL_UNIFORM_BUFFER, ID);
-	glBufferData(GL_UNIFORM_BUFFER, size, vertices, GL_STATIC_DRAW);
+	glBufferData(GL_UNIFORM_BUFFER, size, vertices, usage);
 }
 void UBO::Bind() 	{ glBindBuffer(GL_UNIFORM_BUFFER, ID); }
+void UBO::BindBase(GLuint binding) { glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID); }
+void UBO::Update(const void* data, GLsizeiptr size) {
+	glBindBuffer(GL_UNIFORM_BUFFER, ID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+}
 void UBO::Unbind()	{ glBindBuffer(GL_UNIFORM_BUFFER, 0); }
 void UBO::Delete() 	{ glDeleteBuffers(1, &ID); }
 
@@ -97,6 +102,12 @@ VAO::VAO(GLfloat* vertices, GLsizeiptr verticesSize) : vbo(), ebo() {
 	glBindVertexArray(ID);
 	vbo = VBO(vertices, verticesSize);
 }
+VAO::VAO(const VBO& shared_vbo, const EBO& shared_ebo) : vbo(shared_vbo), ebo(shared_ebo) {
+	// Vertex arrays are never shared between contexts, the buffers they point into can be
+	glGenVertexArrays(1, &ID);
+	glBindVertexArray(ID);
+	ebo.Bind();
+}
 void VAO::NewIndeces(GLuint* indeces, GLsizeiptr indecesSize) {
 	glGenVertexArrays(1, &ID);
 	glBindVertexArray(ID);
@@ -1,4 +1,5 @@
 #include <string>
+#include <sstream>
 #include "cla.h"
 
 CLAs parse(int argc, char** argv){
@@ -12,6 +13,45 @@ CLAs parse(int argc, char** argv){
             out.monitorIndex = std::stoi(argv[++i]);
         } else if (std::string(argv[i]) == "--shader" && i + 1 < argc) {
             out.shaderPath = argv[++i];
+        } else if (std::string(argv[i]) == "--audio-file" && i + 1 < argc) {
+            out.audioFile = argv[++i];
+        } else if (std::string(argv[i]) == "--features" && i + 1 < argc) {
+            out.featureFile = argv[++i];
+        } else if (std::string(argv[i]) == "--group" && i + 1 < argc) {
+            out.group = argv[++i];
+        } else if (std::string(argv[i]) == "--record" && i + 1 < argc) {
+            out.recordFile = argv[++i];
+        } else if (std::string(argv[i]) == "--replay" && i + 1 < argc) {
+            out.replayFile = argv[++i];
+        } else if (std::string(argv[i]) == "--render-scale" && i + 1 < argc) {
+            out.renderScale = std::stof(argv[++i]);
+        } else if (std::string(argv[i]) == "--target-fps" && i + 1 < argc) {
+            out.targetFps = std::stof(argv[++i]);
+        } else if (std::string(argv[i]) == "--sharpen") {
+            out.sharpen = true;
+        } else if (std::string(argv[i]) == "--temporal") {
+            out.temporal = true;
+        } else if (std::string(argv[i]) == "--web-detail" && i + 1 < argc) {
+            out.webDetail = std::stof(argv[++i]);
+        } else if (std::string(argv[i]) == "--depth-prepass") {
+            out.depthPrepass = true;
+        } else if (std::string(argv[i]) == "--on-change") {
+            out.onChange = true;
+        } else if (std::string(argv[i]) == "--impulse-test") {
+            out.impulseTest = true;
+        } else if (std::string(argv[i]) == "--offline") {
+            out.offline = true;
+        } else if (std::string(argv[i]) == "--frames" && i + 1 < argc) {
+            out.benchFrames = std::stoi(argv[++i]);
+        } else if (std::string(argv[i]) == "--inputs" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string entry;
+            while (std::getline(list, entry, ',')) {
+                size_t split = entry.find(':');
+                int device   = std::stoi(entry.substr(0, split));
+                int channels = (split == std::string::npos) ? 1 : std::stoi(entry.substr(split + 1));
+                out.inputs.emplace_back(device, channels);
+            }
         }
     }
     return out;
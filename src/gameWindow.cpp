@@ -58,8 +58,9 @@ void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
     uniforms->scroll += float(yoffset/10.0);
 }
 
-GLFWwindow* initializeWindow(unsigned int width, unsigned int height, const char* title, bool fullscreen, int monitorIndex) {
-    GLFWwindow* window = simplestWindow(width, height, title);
+GLFWwindow* initializeWindow(unsigned int width, unsigned int height, const char* title, bool fullscreen, int monitorIndex,
+                             GLFWwindow* share) {
+    GLFWwindow* window = simplestWindow(width, height, title, share);
 
     // Always create windowed, and apply borderless fullscreen manually if needed
     glfwWindowHint(GLFW_DECORATED, fullscreen ? GLFW_FALSE : GLFW_TRUE);
@@ -120,13 +121,17 @@ void accountSpin(Uniforms* uniforms, CameraInfo &camera_info) {
     accountSpin(uniforms, camera_info, 1.0f, 150.0f, 0.0f);
 }
 void accountSpin(Uniforms* uniforms, CameraInfo &camera_info, float scale, float fov, float scroll) {
-    const float ds = rand();
-    static glm::mat4 rotation = glm::mat4({
-        1.0f,  0.0f,    0.0f, 0.0f,
-        0.0f,  cos(ds), 0.0f, sin(ds),
-        0.0f,  0.0f,    1.0f, 0.0f,
-        0.0f, -sin(ds), 0.0f, cos(ds)
-    }); // provides variance and avoids horizontal line aliasing
+    if (!camera_info.spinning) {
+        const float ds = rand();
+        camera_info.Spin = glm::mat4({
+            1.0f,  0.0f,    0.0f, 0.0f,
+            0.0f,  cos(ds), 0.0f, sin(ds),
+            0.0f,  0.0f,    1.0f, 0.0f,
+            0.0f, -sin(ds), 0.0f, cos(ds)
+        }); // provides variance and avoids horizontal line aliasing
+        camera_info.spinning = true;
+    }
+    glm::mat4& rotation = camera_info.Spin;
     float ratio = float(uniforms->windWidth)/float(uniforms->windHeight);
     float dt = std::min( float(uniforms->this_time-uniforms->last_time), 0.01f);    
     scroll+=uniforms->scroll;
@@ -149,21 +154,19 @@ void accountSpin(Uniforms* uniforms, CameraInfo &camera_info, float scale, float
     camera_info.Projection  = glm::perspective(glm::radians(fov), ratio, 0.01f, 100.0f);
 }
 
-GLuint getSpellSubroutine(Uniforms* uniforms, Grimoire& grimoire, GLuint shader_id) {
-    static GLuint subroutine_index = 0;    
+SpellEffect getSpellEffect(Uniforms* uniforms, Grimoire& grimoire) {
+    static SpellEffect effect = SPELL_EMPTY;
     float current_time = glfwGetTime();
     if (uniforms->click_states[0] && !grimoire.active_spell->spell_life && !grimoire.flipping()) {
         // The mouse is being held down... AND the spell is not currently running.
         if(!grimoire.active_spell->click_time) {
-            subroutine_index = glGetSubroutineIndex(shader_id, GL_FRAGMENT_SHADER, 
-                                                    grimoire.active_spell->cast_subroutine);
+            effect = grimoire.active_spell->cast_effect;
             // And it's the first frame of it being held down...
             grimoire.active_spell->click_time = current_time;
         }
         grimoire.chargeSpell(current_time, uniforms->player_context);
     } else if (grimoire.active_spell->click_time) {        
-        subroutine_index = glGetSubroutineIndex(shader_id, GL_FRAGMENT_SHADER,
-                                                grimoire.active_spell->release_subroutine);
+        effect = grimoire.active_spell->release_effect;
         // The mouse was JUST released
         grimoire.startSpell(current_time, uniforms->player_context);
     } else if (grimoire.active_spell->spell_life) {
@@ -171,8 +174,8 @@ GLuint getSpellSubroutine(Uniforms* uniforms, Grimoire& grimoire, GLuint shader_
         // If its at 0.0f this will not be triggered..
         grimoire.updateSpellLife(current_time, uniforms->player_context);
         if (grimoire.active_spell->spell_life == 0.0f) {
-            subroutine_index = glGetSubroutineIndex(shader_id, GL_FRAGMENT_SHADER, "emptySpell");
-            // The spell is complete, we change the subroutine for the last pass..
+            effect = SPELL_EMPTY;
+            // The spell is complete, we change the program for the last pass..
             grimoire.updateSpellLife(current_time, uniforms->player_context);
             //And ensure that 0.0f is passed so that cleanup can occur.
         }
@@ -187,7 +190,7 @@ GLuint getSpellSubroutine(Uniforms* uniforms, Grimoire& grimoire, GLuint shader_
             grimoire.updateFlip(current_time);
         }
     }
-    return subroutine_index;
+    return effect;
 }
 
 
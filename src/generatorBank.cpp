@@ -0,0 +1,171 @@
+#include <cstring>
+#include <cmath>
+#include "generatorBank.h"
+
+// Same vector extension as BandFilter: four lanes per step, per-lane choices are mask blends.
+typedef float    lane_vec  __attribute__((vector_size(16)));
+typedef int      lane_mask __attribute__((vector_size(16)));
+typedef uint32_t lane_bits __attribute__((vector_size(16)));
+
+enum { SINUSOID, SQUARE, TRIANGLE, SAWTOOTH, NOISE, CONSTANT };
+
+static lane_vec splat(float v) { return lane_vec{v, v, v, v}; }
+static lane_vec load(const std::vector<float>& a, int i) { lane_vec v; memcpy(&v, &a[i], sizeof(v)); return v; }
+static void store(std::vector<float>& a, int i, lane_vec v) { memcpy(&a[i], &v, sizeof(v)); }
+static lane_vec blend(lane_mask mask, lane_vec a, lane_vec b) {
+    return (lane_vec)((mask & (lane_mask)a) | (~mask & (lane_mask)b));
+}
+static lane_vec floor4(lane_vec x) {
+    lane_vec t = __builtin_convertvector(__builtin_convertvector(x, lane_mask), lane_vec);
+    return blend(t > x, t - splat(1.0f), t);
+}
+static lane_vec abs4(lane_vec x) {
+    const lane_mask magnitude = {0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF};
+    return (lane_vec)((lane_mask)x & magnitude);
+}
+
+// sin(2 pi x) for any x: parabola through the half-period, then one refinement step (error < 0.001)
+static lane_vec sinCycle(lane_vec x) {
+    lane_vec t = x - floor4(x) - splat(0.5f);
+    lane_vec y = splat(8.0f) * t - splat(16.0f) * t * abs4(t);
+    y = splat(0.225f) * (y * abs4(y) - y) + y;
+    return -y;
+}
+
+// xorshift32 per lane, mapped onto [-1, 1) through the mantissa
+static lane_vec noise4(lane_bits& s) {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    lane_bits bits = (s >> 9) | 0x3F800000u;
+    return (lane_vec)bits * splat(2.0f) - splat(3.0f);
+}
+
+template <int Mode>
+static void advance(GeneratorLanes& l, float dt) {
+    const int padded = l.out.size();
+    for (int i = 0; i < padded; i += GENERATOR_LANES) {
+        lane_vec amp = load(l.amplitude, i);
+        lane_vec c = load(l.cycle, i) + load(l.frequency, i) * splat(dt);
+        c -= floor4(c);
+        store(l.cycle, i, c);
+
+        lane_vec y;
+        if constexpr (Mode == SINUSOID) {
+            y = amp * sinCycle(c + load(l.phase, i) * splat(0.5f / (float)M_PI));
+        } else if constexpr (Mode == SQUARE) {
+            y = blend(c < load(l.duty, i), amp, -amp);
+        } else if constexpr (Mode == TRIANGLE) {
+            y = amp * blend(c < splat(0.5f), splat(4.0f) * c - splat(1.0f), splat(3.0f) - splat(4.0f) * c);
+        } else if constexpr (Mode == SAWTOOTH) {
+            y = amp * (splat(2.0f) * c - splat(1.0f));
+        } else if constexpr (Mode == NOISE) {
+            // Random walk bounded by the amplitude
+            lane_bits s;
+            memcpy(&s, &l.seed[i], sizeof(s));
+            y = load(l.walk, i) + noise4(s) * load(l.speed, i) * splat(dt);
+            y = blend(y > amp, amp, blend(y < -amp, -amp, y));
+            memcpy(&l.seed[i], &s, sizeof(s));
+            store(l.walk, i, y);
+        } else {
+            y = load(l.constant, i);
+        }
+        store(l.out, i, y);
+    }
+    for (int i = 0; i < l.count; ++i) *l.targets[i] = l.out[i];
+}
+
+void GeneratorBank::update(float dt) {
+    advance<SINUSOID>(lanes[SINUSOID], dt);
+    advance<SQUARE>(lanes[SQUARE], dt);
+    advance<TRIANGLE>(lanes[TRIANGLE], dt);
+    advance<SAWTOOTH>(lanes[SAWTOOTH], dt);
+    advance<NOISE>(lanes[NOISE], dt);
+    advance<CONSTANT>(lanes[CONSTANT], dt);
+}
+
+void GeneratorBank::add(int mode, const GeneratorSettings& s, float* target, int* slot, float cycle) {
+    GeneratorLanes& l = lanes[mode];
+    int i = l.count++;
+    int padded = (l.count + GENERATOR_LANES - 1) / GENERATOR_LANES * GENERATOR_LANES;
+    for (std::vector<float>* a : {&l.cycle, &l.frequency, &l.amplitude, &l.phase, &l.duty,
+                                  &l.speed, &l.constant, &l.walk, &l.out}) {
+        a->resize(padded, 0.0f);
+    }
+    l.seed.resize(padded, 1u);
+    l.targets.push_back(target);
+    l.slots.push_back(slot);
+
+    next_seed = next_seed * 1664525u + 1013904223u;
+    l.seed[i]  = next_seed | 1u; // xorshift must not start at zero
+    l.cycle[i] = cycle;
+    l.walk[i]  = 0.0f;
+    *slot = i;
+    set(mode, i, s);
+}
+
+void GeneratorBank::set(int mode, int i, const GeneratorSettings& s) {
+    GeneratorLanes& l = lanes[mode];
+    l.frequency[i] = s.frequency;
+    l.amplitude[i] = s.amplitude;
+    l.phase[i]     = s.phase;
+    l.duty[i]      = s.dutyCycle;
+    l.speed[i]     = s.speed;
+    l.constant[i]  = s.constantValue;
+}
+
+void GeneratorBank::remove(int mode, int i) {
+    // Swap the last lane into the hole and tell its generator where it went
+    GeneratorLanes& l = lanes[mode];
+    int last = --l.count;
+    for (std::vector<float>* a : {&l.cycle, &l.frequency, &l.amplitude, &l.phase, &l.duty,
+                                  &l.speed, &l.constant, &l.walk, &l.out}) {
+        (*a)[i] = (*a)[last];
+        (*a)[last] = 0.0f;
+    }
+    l.seed[i] = l.seed[last];
+    l.targets[i] = l.targets[last];
+    l.slots[i] = l.slots[last];
+    *l.slots[i] = i;
+    l.targets.pop_back();
+    l.slots.pop_back();
+}
+
+void GeneratorBank::move(int from, int i, int to) {
+    GeneratorLanes& l = lanes[from];
+    GeneratorSettings s = {l.frequency[i], l.amplitude[i], l.phase[i], l.duty[i], l.speed[i], l.constant[i]};
+    float cycle = l.cycle[i];
+    float* target = l.targets[i];
+    int* slot = l.slots[i];
+    remove(from, i);
+    add(to, s, target, slot, cycle);
+}
+
+bool GeneratorBank::wave(int mode, int i, GeneratorWave& w) const {
+    if (mode > SAWTOOTH || i < 0) return false;
+    const GeneratorLanes& l = lanes[mode];
+    w.mode      = mode;
+    w.cycle     = l.cycle[i];
+    w.frequency = l.frequency[i];
+    w.amplitude = l.amplitude[i];
+    w.phase     = l.phase[i];
+    w.duty      = l.duty[i];
+    return true;
+}
+
+// Scalar twin of advance(), with the exact sine
+float GeneratorWave::at(float c) const {
+    c -= floorf(c);
+    switch (mode) {
+        case SINUSOID: return amplitude * sinf(2.0f * (float)M_PI * c + phase);
+        case SQUARE:   return c < duty ? amplitude : -amplitude;
+        case TRIANGLE: return amplitude * (c < 0.5f ? 4.0f * c - 1.0f : 3.0f - 4.0f * c);
+        default:       return amplitude * (2.0f * c - 1.0f);
+    }
+}
+
+int GeneratorBank::size() const {
+    int total = 0;
+    for (const GeneratorLanes& l : lanes) total += l.count;
+    return total;
+}
@@ -1,16 +1,12 @@
 #include "graphicsPipe.h"
 
-float GraphicsPipe::time = 0.0f;
-float GraphicsPipe::previousTime = 0.0f;
-int GraphicsPipe::frameCount = 0;
-
 void GraphicsPipe::initHere(GLFWwindow* w) {
     window = w;
     window_uniforms = getUniforms(window);
 
     switch (type) {
         case PipeType::SPIN:
-            shader_interface = new SpinPatterns(clas, window_uniforms);
+            shader_interface = new SpinPatterns(clas, window_uniforms, assets);
             break;
         case PipeType::FRAGMENT:
             shader_interface = new FragPatterns(clas, window_uniforms);
@@ -23,6 +19,12 @@ void GraphicsPipe::initHere(GLFWwindow* w) {
     frameCount = 0;
 }
 
+void GraphicsPipe::initHosted(GLFWwindow* w, SharedAssets* a) {
+    assets = a;
+    window_name = type == PipeType::FRAGMENT ? "FRAGMENT SHADER" : "DODECAPLEX";
+    initHere(w);
+}
+
 void GraphicsPipe::initWindowed() {
     // Set window_name based on type before creating window
     switch (type) {
@@ -40,11 +42,26 @@ void GraphicsPipe::initWindowed() {
     GLFWwindow* window = initializeWindow(1024, 1024, window_name,
                                 clas.fullscreen, clas.monitorIndex);
     initHere(window);
+    watchShaders();
     window = nullptr;
 }
 
+void GraphicsPipe::watchShaders() {
+    if (!watcher) watcher = new ShaderWatcher(window);
+}
+
 void GraphicsPipe::establishShaders() {
+    // Once running, a reload relinks in the background and the current programs keep drawing
+    if (compiled && watcher) {
+        watcher->reloadAll();
+        window_uniforms->loading = false;
+        return;
+    }
     shader_interface->compile();
+    if (watcher && !compiled) {
+        for (ShaderProgram* program : shader_interface->watchedPrograms()) watcher->watch(program);
+    }
+    compiled = true;
 
     window_uniforms->last_time = glfwGetTime();    
     window_uniforms->loading = false;
@@ -55,32 +72,63 @@ void GraphicsPipe::establishShaders() {
 
 void GraphicsPipe::renderNextFrame(bool swapBuffers) {
     if (window_uniforms->loading) establishShaders();
+    if (watcher && watcher->poll()) shader_interface->locate();
 
-    time = glfwGetTime();
+    time = clas.fixedStep() ? renderedFrames / OFFLINE_FPS : glfwGetTime();
     window_uniforms->this_time = time;
     frameCount++;
+    if (renderedFrames++ == 0) benchStart = glfwGetTime();
 
-    if (time - previousTime >= 1.0) {
-        std::string fpsTitle = std::string(window_name) + " - FPS: " + std::to_string(frameCount);
-        glfwSetWindowTitle(window, fpsTitle.c_str());
+    if (!clas.fixedStep() && time - previousTime >= 1.0) {
+        fps = frameCount;
+        if (!assets) {
+            std::string fpsTitle = std::string(window_name) + " - FPS: " + std::to_string(frameCount);
+            glfwSetWindowTitle(window, fpsTitle.c_str());
+        }
         frameCount = 0;
         previousTime = time;
     }
     
+    // Window events of hosted pipes arrive on the main thread, where resizeCallback cannot reach this context
+    if (assets) glViewport(0, 0, window_uniforms->windWidth, window_uniforms->windHeight);
     glClearColor(0.f, 0.f, 0.f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     shader_interface->render();
 
     if (swapBuffers) {
-        glfwSwapInterval(1);
+        glfwSwapInterval(clas.offline ? 0 : 1);
         glfwSwapBuffers(window);        
     }
-    glfwPollEvents();
+    if (!assets) glfwPollEvents();
     window_uniforms->last_time = time;
 }
 
+void GraphicsPipe::waitForChange() {
+    if (clas.onChange && !clas.fixedStep()) shader_interface->waitForChange(ON_CHANGE_WAIT_MS);
+}
+
+bool GraphicsPipe::benchmarkComplete() {
+    bool replayed = shader_interface && shader_interface->replay.finished();
+    bool counted  = clas.benchFrames > 0 && renderedFrames >= clas.benchFrames;
+    if (!replayed && !counted) return false;
+
+    glFinish();
+    double elapsed = glfwGetTime() - benchStart;
+    std::cout << "Rendered " << renderedFrames << " frames in " << elapsed << "s ("
+              << 1000.0 * elapsed / renderedFrames << " ms/frame, "
+              << renderedFrames / elapsed << " fps)" << std::endl;
+
+    AudioNest* audio_nest = shader_interface->audio_nest;
+    if (audio_nest && audio_nest->analysis_hops) {
+        std::cout << "Audio analysis: " << audio_nest->analysis_hops << " hops, "
+                  << 1e6 * audio_nest->analysis_seconds / audio_nest->analysis_hops << " us/hop" << std::endl;
+    }
+    return true;
+}
+
 GraphicsPipe::~GraphicsPipe() {
+    delete watcher;
     if (shader_interface) {
         delete shader_interface;
     }
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <algorithm>
+#include "modulationGraph.h"
+
+static float lfoWave(int shape, float phase) {
+    switch (shape) {
+        case 1:  return phase < 0.5f ? 4.0f * phase - 1.0f : 3.0f - 4.0f * phase; // Triangle
+        case 2:  return 2.0f * phase - 1.0f;                                      // Sawtooth
+        case 3:  return phase < 0.5f ? 1.0f : -1.0f;                              // Square
+        default: return sinf(2.0f * (float)M_PI * phase);
+    }
+}
+
+void ModulationProgram::run(float* r, float* results, float dt) {
+    r[REGISTER_ZERO] = 0.0f;
+    r[REGISTER_ONE]  = 1.0f;
+    for (ModulationOp& op : ops) {
+        const int* in = op.in;
+        const float* k = op.k;
+        switch (op.kind) {
+            case ModulationKind::Add:
+                r[op.out] = r[in[0]] + r[in[1]] + r[in[2]] + r[in[3]];
+                break;
+            case ModulationKind::Multiply:
+                r[op.out] = r[in[0]] * r[in[1]] * r[in[2]] * r[in[3]];
+                break;
+            case ModulationKind::Clamp:
+                r[op.out] = std::min(std::max(r[in[0]], k[0]), k[1]);
+                break;
+            case ModulationKind::MapRange: {
+                float span = k[1] - k[0];
+                float t = span != 0.0f ? (r[in[0]] - k[0]) / span : 0.0f;
+                r[op.out] = k[2] + t * (k[3] - k[2]);
+                break;
+            }
+            case ModulationKind::Slew: {
+                float& y = op.state[0];
+                float delta = r[in[0]] - y;
+                float rate = delta > 0.0f ? k[0] : k[1];
+                if (rate > 0.0f) delta = std::max(-rate * dt, std::min(rate * dt, delta));
+                y += delta;
+                r[op.out] = y;
+                break;
+            }
+            case ModulationKind::SampleHold: {
+                float trigger = r[in[1]];
+                if (trigger >= k[0] && op.state[1] < k[0]) op.state[0] = r[in[0]];
+                op.state[1] = trigger;
+                r[op.out] = op.state[0];
+                break;
+            }
+            case ModulationKind::Lfo: {
+                float& phase = op.state[0];
+                float sync = r[in[0]];
+                if (sync >= 0.5f && op.state[1] < 0.5f) phase = 0.0f;
+                op.state[1] = sync;
+                phase += k[0] * (1.0f + r[in[1]]) * dt;
+                phase -= floorf(phase);
+                r[op.out] = k[2] * lfoWave((int)k[1], phase);
+                break;
+            }
+            case ModulationKind::Store:
+                results[op.out] = k[1] + std::min(r[in[0]] * k[0], k[2]);
+                break;
+        }
+    }
+}
+
+void ModulationProgram::adoptState(const ModulationProgram& previous) {
+    for (ModulationOp& op : ops) {
+        if (op.node < 0) continue;
+        for (const ModulationOp& old : previous.ops) {
+            if (old.node == op.node && old.kind == op.kind) {
+                op.state[0] = old.state[0];
+                op.state[1] = old.state[1];
+                break;
+            }
+        }
+    }
+}
+
+void GraphExecutor::step(const std::vector<float>& loads, const std::vector<GeneratorWave>& waves, float dt,
+                         std::vector<float>& registers, std::vector<float>& results) {
+    const size_t params = program.params.size();
+    registers.resize(program.registerCount);
+    results.resize(samples * params);
+    float* first = registers.data() + FIRST_LOAD_REGISTER;
+    if (samples == 1) {
+        std::copy(loads.begin(), loads.end(), first);
+        program.run(registers.data(), results.data(), dt);
+        return;
+    }
+
+    // The first hop of a program has no history: it starts flat at its own sources
+    if (previous_loads.size() != loads.size()) previous_loads = loads;
+    const float sub_dt = dt / (samples - 1);
+    for (int s = 1; s < samples; ++s) {
+        float f = (float)s / (samples - 1);
+        for (size_t i = 0; i < loads.size(); ++i) first[i] = previous_loads[i] + f * (loads[i] - previous_loads[i]);
+        for (const GeneratorWave& w : waves) first[w.load] = w.at(w.cycle - w.frequency * dt * (1.0f - f));
+        program.run(registers.data(), results.data() + s * params, sub_dt);
+    }
+    if (previous_results.size() == params) {
+        std::copy(previous_results.begin(), previous_results.end(), results.begin());
+    } else {
+        std::copy(results.begin() + params, results.begin() + 2 * params, results.begin());
+    }
+    previous_loads = loads;
+    previous_results.assign(results.end() - params, results.end());
+}
+
+GraphExecutor::GraphExecutor(int sample_count) : samples(sample_count < 1 ? 1 : sample_count) {
+    worker = std::thread(&GraphExecutor::loop, this);
+}
+
+GraphExecutor::~GraphExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void GraphExecutor::install(const ModulationProgram& p) {
+    std::lock_guard<std::mutex> lock(mutex);
+    next_program = p;
+    program_pending = true;
+    step_pending = false;
+    generation++;
+}
+
+void GraphExecutor::submit(const std::vector<float>& loads, const std::vector<GeneratorWave>& waves, float dt, double time) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        step_loads = loads;
+        step_waves = waves;
+        step_dt = dt;
+        step_time = time;
+        step_pending = true;
+    }
+    wake.notify_one();
+}
+
+bool GraphExecutor::collect(std::vector<float>& results, std::vector<float>& registers, double& time, float& dt) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out_ready || out_generation != generation) return false;
+    results.swap(out_results);
+    registers.swap(out_registers);
+    time = out_time;
+    dt = out_dt;
+    out_ready = false;
+    return true;
+}
+
+void GraphExecutor::loop() {
+    std::vector<float> loads, registers, results;
+    std::vector<GeneratorWave> waves;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || step_pending; });
+        if (stopping) return;
+        if (program_pending) {
+            next_program.adoptState(program);
+            std::swap(program, next_program);
+            program_pending = false;
+            previous_loads.clear();
+            previous_results.clear();
+        }
+        unsigned step_generation = generation;
+        float dt = step_dt;
+        double time = step_time;
+        loads.swap(step_loads);
+        waves.swap(step_waves);
+        step_pending = false;
+        if (loads.size() != program.inputs.size()) continue; // Queued before the program changed
+        lock.unlock();
+
+        // Evaluate without the lock, the UI thread keeps queueing hops meanwhile
+        step(loads, waves, dt, registers, results);
+
+        lock.lock();
+        out_results.assign(results.begin(), results.end());
+        out_registers.assign(registers.begin(), registers.end());
+        out_time = time;
+        out_dt = dt;
+        out_generation = step_generation;
+        out_ready = true;
+    }
+}
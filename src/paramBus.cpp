@@ -0,0 +1,135 @@
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "paramBus.h"
+
+#ifdef MSG_NOSIGNAL
+#define BUS_SEND_FLAGS (MSG_DONTWAIT | MSG_NOSIGNAL)
+#else
+#define BUS_SEND_FLAGS MSG_DONTWAIT // macOS: SIGPIPE is disabled per socket with SO_NOSIGPIPE
+#endif
+
+std::string groupPath(const std::string& group, const char* suffix) {
+    // The default group keeps the historical /tmp/uniforms.dat
+    if (group.empty() || group == DEFAULT_GROUP) return std::string("/tmp/uniforms") + suffix;
+    std::string name;
+    for (char c : group) name += (isalnum((unsigned char)c) || c == '-' || c == '_') ? c : '_';
+    return "/tmp/uniforms-" + name + suffix;
+}
+
+static bool socketAddress(const std::string& socket_path, sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << socket_path << "\n";
+        return false;
+    }
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+static void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+BusServer::~BusServer() {
+    for (int client : clients) close(client);
+    if (fd == -1) return;
+    close(fd);
+    unlink(path.c_str());
+}
+
+bool BusServer::listen(const std::string& socket_path) {
+    sockaddr_un addr;
+    if (!socketAddress(socket_path, addr)) return false;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return false;
+    unlink(socket_path.c_str()); // Left over from a writer that did not exit cleanly
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) == -1 || ::listen(fd, 16) == -1) {
+        std::cerr << "Failed to listen on " << socket_path << ": " << strerror(errno) << "\n";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    setNonBlocking(fd);
+    path = socket_path;
+    return true;
+}
+
+void BusServer::acceptPending() {
+    if (fd == -1) return;
+    int client;
+    while ((client = accept(fd, nullptr, nullptr)) != -1) {
+        setNonBlocking(client);
+        clients.push_back(client);
+    }
+}
+
+void BusServer::notify(uint32_t sequence) {
+    for (size_t i = 0; i < clients.size();) {
+        ssize_t sent = send(clients[i], &sequence, sizeof(sequence), BUS_SEND_FLAGS);
+        if (sent == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            // Renderer went away. A full buffer (EAGAIN) is fine, it already has a wakeup pending.
+            close(clients[i]);
+            clients[i] = clients.back();
+            clients.pop_back();
+            continue;
+        }
+        ++i;
+    }
+}
+
+bool BusClient::connect(const std::string& socket_path) {
+    disconnect();
+    sockaddr_un addr;
+    if (!socketAddress(socket_path, addr)) return false;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) return false;
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    setNonBlocking(fd);
+    return true;
+}
+
+void BusClient::disconnect() {
+    if (fd == -1) return;
+    close(fd);
+    fd = -1;
+}
+
+bool BusClient::drain() {
+    if (fd == -1) return false;
+    bool notified = false;
+    uint32_t sequences[64];
+    while (true) {
+        ssize_t got = recv(fd, sequences, sizeof(sequences), MSG_DONTWAIT);
+        if (got > 0) {
+            notified = true;
+            continue;
+        }
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            disconnect(); // select closed the group
+        }
+        return notified;
+    }
+}
+
+bool BusClient::wait(int timeout_ms) {
+    if (fd == -1) return false;
+    pollfd entry = {fd, POLLIN, 0};
+    return poll(&entry, 1, timeout_ms) > 0;
+}
@@ -0,0 +1,111 @@
+#include <fstream>
+#include <iterator>
+#include "paramRecorder.h"
+
+// Latency probes and curve timestamps only mean something in the process that stamped them.
+// Replays step time themselves, so curve-driven parameters are recorded by their scalars.
+static void clearProbes(UniformStructure& u) {
+    u.capture_time  = 0.0;
+    u.analysis_time = 0.0;
+    u.routing_time  = 0.0;
+    u.impulse_seq   = 0;
+    u.curves = ParamCurves{};
+}
+
+bool ParamRecorder::open(const std::string& file_path) {
+    close();
+    file = fopen(file_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open recording: " << file_path << "\n";
+        return false;
+    }
+    RecordingHeader header = {RECORDING_MAGIC, RECORDING_VERSION, UNIFORMS_VERSION, sizeof(UniformStructure)};
+    fwrite(&header, sizeof(header), 1, file);
+    memset(previous, 0, sizeof(previous));
+    path = file_path;
+    return true;
+}
+
+void ParamRecorder::close() {
+    if (!file) return;
+    fclose(file);
+    file = nullptr;
+}
+
+void ParamRecorder::record(float time, const UniformStructure& u) {
+    if (!file) return;
+    UniformStructure clean = u;
+    clearProbes(clean);
+    uint32_t words[RECORDING_WORDS];
+    memcpy(words, &clean, sizeof(words));
+
+    // Frame: float time, uint16 count, then count x (uint16 word index, uint32 word)
+    frame.resize(sizeof(float) + sizeof(uint16_t));
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < RECORDING_WORDS; ++i) {
+        if (words[i] == previous[i]) continue;
+        const uint8_t* index = (const uint8_t*)&i;
+        const uint8_t* word  = (const uint8_t*)&words[i];
+        frame.insert(frame.end(), index, index + sizeof(uint16_t));
+        frame.insert(frame.end(), word, word + sizeof(uint32_t));
+        previous[i] = words[i];
+        count++;
+    }
+    if (count == 0) return;
+    memcpy(frame.data(), &time, sizeof(float));
+    memcpy(frame.data() + sizeof(float), &count, sizeof(uint16_t));
+    fwrite(frame.data(), 1, frame.size(), file);
+}
+
+bool ParamPlayer::open(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open recording: " << path << "\n";
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    RecordingHeader header;
+    if (bytes.size() < sizeof(header)) {
+        std::cerr << "Recording too short: " << path << "\n";
+        bytes.clear();
+        return false;
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != RECORDING_MAGIC || header.version != RECORDING_VERSION
+        || header.layout != UNIFORMS_VERSION || header.size != sizeof(UniformStructure)) {
+        std::cerr << "Recording " << path << " was made by an incompatible build.\n";
+        bytes.clear();
+        return false;
+    }
+    cursor = sizeof(header);
+    return true;
+}
+
+bool ParamPlayer::advance(float time, UniformStructure& out) {
+    bool changed = false;
+    const size_t prefix = sizeof(float) + sizeof(uint16_t);
+    const size_t entry  = sizeof(uint16_t) + sizeof(uint32_t);
+    while (cursor + prefix <= bytes.size()) {
+        float frame_time;
+        uint16_t count;
+        memcpy(&frame_time, &bytes[cursor], sizeof(float));
+        memcpy(&count, &bytes[cursor + sizeof(float)], sizeof(uint16_t));
+        if (frame_time > time) break;
+        if (cursor + prefix + count * entry > bytes.size()) {
+            cursor = bytes.size(); // Truncated final frame, e.g. select was killed mid-write
+            break;
+        }
+
+        const uint8_t* p = &bytes[cursor + prefix];
+        for (uint16_t i = 0; i < count; ++i, p += entry) {
+            uint16_t index;
+            memcpy(&index, p, sizeof(uint16_t));
+            if (index < RECORDING_WORDS) memcpy(&state[index], p + sizeof(uint16_t), sizeof(uint32_t));
+        }
+        cursor += prefix + count * entry;
+        changed = true;
+    }
+    if (changed) memcpy(&out, state, sizeof(UniformStructure));
+    return changed;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "presetFormat.h"
+
+bool PresetFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false; // Empty slot
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(PresetHeader)) {
+        std::cerr << "Preset file too small: " << path << "\n";
+        ::close(fd);
+        return false;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (map == MAP_FAILED) {
+        std::cerr << "Failed to map preset file: " << path << "\n";
+        return false;
+    }
+
+    const PresetHeader* h = (const PresetHeader*)map;
+    size_t expected = sizeof(PresetHeader) + (size_t)h->sources * sizeof(PresetSource)
+                    + (size_t)h->links * sizeof(PresetLink) + h->ini_bytes;
+    if (h->magic != PRESET_MAGIC || h->version != PRESET_VERSION || (size_t)info.st_size < expected) {
+        std::cerr << "Invalid preset file: " << path << "\n";
+        munmap(map, info.st_size);
+        return false;
+    }
+
+    header      = h;
+    sources     = (const PresetSource*)(h + 1);
+    links       = (const PresetLink*)(sources + h->sources);
+    ini         = (const char*)(links + h->links);
+    mapped_size = info.st_size;
+    return true;
+}
+
+void PresetFile::close() {
+    if (!header) return;
+    munmap((void*)header, mapped_size);
+    header = nullptr;
+    sources = nullptr;
+    links = nullptr;
+    ini = nullptr;
+    mapped_size = 0;
+}
+
+bool writePresetFile(const std::string& path, int32_t next_source_id, const std::vector<PresetSource>& sources,
+                     const std::vector<PresetLink>& links, const std::string& ini) {
+    PresetHeader header;
+    header.magic          = PRESET_MAGIC;
+    header.version        = PRESET_VERSION;
+    header.sources        = sources.size();
+    header.links          = links.size();
+    header.ini_bytes      = ini.size();
+    header.next_source_id = next_source_id;
+
+    // Write beside the target and rename over it, so a mapped preset never sees a half-written file
+    std::string temp = path + ".tmp";
+    std::ofstream out(temp, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to write preset file: " << path << "\n";
+        return false;
+    }
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)sources.data(), sources.size() * sizeof(PresetSource));
+    out.write((const char*)links.data(), links.size() * sizeof(PresetLink));
+    out.write(ini.data(), ini.size());
+    out.close();
+    if (!out || rename(temp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write preset file: " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+#include "rendererHost.h"
+
+void SharedAssets::load(GLFWwindow* root) {
+    spin_shader = ShaderProgram(
+        SHADER_DIR "/spin.vert",
+        SHADER_DIR "/spin.geom",
+        SHADER_DIR "/spin.frag", true);
+    program_generation++;
+    spin_context.initializeMapData();
+    spin_context.populateDodecaplexVAO(RhombusPattern(WebType::DOUBLE_STAR, false), true);
+    watcher = std::make_unique<ShaderWatcher>(root);
+    watcher->watch(&spin_shader);
+    loaded = true;
+}
+
+void SharedAssets::update() {
+    if (!loaded) return;
+    // Outputs copy the program and make it current under the lock; GL keeps a replaced one alive
+    // until no context has it current, so none is used after it is freed
+    std::lock_guard<std::mutex> lock(program_lock);
+    if (reload_requested.exchange(false)) watcher->reloadAll();
+    if (watcher->poll()) program_generation++;
+}
+
+bool RendererHost::addOutput(PipeType type, const CLAs& clas) {
+    if (type == PipeType::GAME) {
+        std::cerr << "The game cannot run as a hosted output" << std::endl;
+        return false;
+    }
+    if (!assets.loaded) assets.load(root);
+
+    const char* title = type == PipeType::SPIN ? "DODECAPLEX" : "FRAGMENT SHADER";
+    GLFWwindow* window = initializeWindow(HOSTED_WIDTH, HOSTED_HEIGHT, title, clas.fullscreen, clas.monitorIndex, root);
+    glfwMakeContextCurrent(root); // Frees the new context for its render thread
+    if (!window) return false;
+
+    RenderOutput* output = new RenderOutput();
+    output->pipe = new GraphicsPipe(type, clas);
+    // Fragment programs belong to their output, so each gets a watcher of its own; made here because
+    // its compile context is a window, and polled by the render thread like a standalone pipe's
+    if (type == PipeType::FRAGMENT) output->pipe->watcher = new ShaderWatcher(root);
+    output->window = window;
+    output->title = title;
+    output->thread = std::thread(&RendererHost::run, output, &assets);
+    outputs.push_back(output);
+    return true;
+}
+
+void RendererHost::run(RenderOutput* output, SharedAssets* assets) {
+    glfwMakeContextCurrent(output->window);
+    GraphicsPipe* pipe = output->pipe;
+    pipe->initHosted(output->window, assets);
+    pipe->establishShaders();
+    while (!output->stopping && !glfwWindowShouldClose(output->window)) {
+        pipe->waitForChange();
+        pipe->renderNextFrame();
+    }
+    glfwMakeContextCurrent(nullptr);
+    output->finished = true;
+}
+
+void RendererHost::poll() {
+    assets.update();
+    for (auto it = outputs.begin(); it != outputs.end();) {
+        RenderOutput* output = *it;
+        if (output->finished) {
+            output->thread.join();
+            glfwDestroyWindow(output->window);
+            delete output->pipe;
+            delete output;
+            it = outputs.erase(it);
+            continue;
+        }
+        int fps = output->pipe->fps;
+        if (fps != output->shown_fps) {
+            std::string title = std::string(output->title) + " - FPS: " + std::to_string(fps);
+            glfwSetWindowTitle(output->window, title.c_str());
+            output->shown_fps = fps;
+        }
+        ++it;
+    }
+}
+
+void RendererHost::closeAll() {
+    for (RenderOutput* output : outputs) output->stopping = true;
+    for (RenderOutput* output : outputs) {
+        output->thread.join();
+        glfwDestroyWindow(output->window);
+        delete output->pipe;
+        delete output;
+    }
+    outputs.clear();
+}
+
+RendererHost::~RendererHost() {
+    closeAll();
+}
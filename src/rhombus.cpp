@@ -308,6 +308,8 @@ void RhombusPattern::assignCorners(array<GoldenRhombus, 5>& rhombuses, Corner co
     vertical_offset = rhombuses[0].corners[corner].z;
     
     for (int i=0; i < 5; i++) web_pentagon[i] = vec4(vec2(rhombuses[i].corners[corner]), 0.0f, 0.0f);
+    assignFan({rhombuses[0].indeces[corner], rhombuses[1].indeces[corner], rhombuses[2].indeces[corner],
+               rhombuses[3].indeces[corner], rhombuses[4].indeces[corner]});
     rescaleValues();
 }
 void RhombusPattern::assignCorners(array<GoldenRhombus*, 5> rhombuses, Corner corner) {
@@ -316,8 +318,23 @@ void RhombusPattern::assignCorners(array<GoldenRhombus*, 5> rhombuses, Corner co
     vertical_offset = rhombuses[0]->corners[corner].z;
     
     for (int i=0; i < 5; i++) web_pentagon[i] = vec4(vec2(rhombuses[i]->corners[corner]), 0.0f, 0.0f);
+    assignFan({rhombuses[0]->indeces[corner], rhombuses[1]->indeces[corner], rhombuses[2]->indeces[corner],
+               rhombuses[3]->indeces[corner], rhombuses[4]->indeces[corner]});
     rescaleValues();
 }
+void RhombusPattern::assignFan(array<GLuint, 5> corner_indeces){
+    // Every web grows out of center[0], whose TOP corner is the middle of the pentagon. The fan keeps
+    // the counter-clockwise winding of the center rhombuses, whichever way the corners were listed.
+    GLuint middle = all_rhombuses.front().indeces[Corner::TOP];
+    bool clockwise = web_pentagon[0].x*web_pentagon[1].y - web_pentagon[0].y*web_pentagon[1].x < 0.0f;
+    for (int i=0; i < 5; i++) {
+        int a = i, b = (i+1)%5;
+        if (clockwise) std::swap(a, b);
+        pentagon_indeces[3*i]   = middle;
+        pentagon_indeces[3*i+1] = corner_indeces[a];
+        pentagon_indeces[3*i+2] = corner_indeces[b];
+    }
+}
 template<long unsigned int N>
 void RhombusPattern::assignEdge(array<GoldenRhombus*, N> rhombuses, int edge_index){
     auto updateMap = [&](GoldenRhombus* r, Corner c){
@@ -707,6 +724,19 @@ void RhombusPattern::buildArrays(CPUBufferPair& buffer_writer, PentagonMemory& p
 void RhombusPattern::buildArrays(CPUBufferPair& buffer_writer, PentagonMemory& pentagon) {
     buildArrays(buffer_writer, pentagon, false);
 }
+void RhombusPattern::buildIndeces(CPUBufferPair& buffer_writer, PentagonMemory& pentagon, WebDetail detail) {
+    switch (detail) {
+    case WebDetail::PLAIN_PENTAGON:
+        for (GLuint index : pentagon_indeces) {
+            buffer_writer.i_buff[buffer_writer.i_head++] = pentagon.i_offset + index;
+        }
+        break;
+    default:
+        for (GoldenRhombus& rhombus : all_rhombuses) {
+            rhombus.writeUints(buffer_writer.i_buff, buffer_writer.i_head, pentagon.i_offset);
+        }
+    }
+}
 void RhombusPattern::rankVerts(mat4& player_view, PentagonMemory& pentagon) {
     vec4 result;
     int i=0;
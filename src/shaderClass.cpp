@@ -1,38 +1,85 @@
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
 #include "shaderClass.h"
+#include "shaderPreprocessor.h"
 
-std::string get_file_contents(const std::string& filename, const std::string& parentPath = "") {
-    // This function recursively builds the shader file accounting for include statements for
-    // other shader files.
-    std::string filePath;
-    if(parentPath.empty()) {
-        filePath = filename;
-    } else {
-        filePath = parentPath + "/" + filename;
-    }
+#define PROGRAM_CACHE_MAGIC 0x42504F44u // "DOPB"
 
-    std::ifstream in(filePath, std::ios::binary);
-    if (in) {
-        std::string contents, line;
-        while (getline(in, line)) {
-            if (line.find("#include") != std::string::npos) {
-                std::size_t start = line.find(" ") + 1;
-                std::size_t end = line.find_last_of("\n") - start;
-                std::string includeFile = line.substr(start, end);
-
-                // Construct the path to the included file relative to the current file
-                std::string includePath = filePath.substr(0, filePath.find_last_of("/\\") + 1);
-
-                // Recursively process the included file
-                contents += get_file_contents(includeFile.c_str(), includePath) + "\n";
-            } else {
-                contents += line + "\n";
-            }
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t format;
+    uint32_t length;
+};
+
+// Cache file for these sources on this driver, empty when the driver cannot hand binaries back
+static std::string programCachePath(const std::string& vertexCode, const std::string& geometryCode,
+                                    const std::string& fragmentCode) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0) return "";
+
+    // FNV-1a, each string closed by a zero byte. A driver update or an edit anywhere in an include
+    // chain changes the key, so stale binaries are never looked up again.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const char* s, size_t n) {
+        for (size_t i = 0; i <= n; ++i) {
+            hash ^= i < n ? (unsigned char)s[i] : 0u;
+            hash *= 0x100000001b3ull;
         }
-        in.close();
-        return contents;
-    } else {
-        std::cerr << "Error loading shader from: " << filePath << std::endl;
-        throw(errno);
+    };
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const char* driver = (const char*)glGetString(name);
+        if (driver) mix(driver, strlen(driver));
+    }
+    mix(vertexCode.data(), vertexCode.size());
+    mix(geometryCode.data(), geometryCode.size());
+    mix(fragmentCode.data(), fragmentCode.size());
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return std::string(PROGRAM_CACHE_DIR) + "/" + name;
+}
+
+static bool loadProgramBinary(GLuint program, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    ProgramCacheHeader header;
+    in.read((char*)&header, sizeof(header));
+    if (!in || header.magic != PROGRAM_CACHE_MAGIC) return false;
+    std::vector<char> binary(header.length);
+    in.read(binary.data(), binary.size());
+    if (!in) return false;
+
+    glProgramBinary(program, header.format, binary.data(), binary.size());
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE; // The driver may refuse binaries from an older build of itself
+}
+
+static void storeProgramBinary(GLuint program, const std::string& path) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    ProgramCacheHeader header = {PROGRAM_CACHE_MAGIC, (uint32_t)format, (uint32_t)length};
+
+    // Renderers launched together may all miss at once: each writes its own file and renames it in
+    std::filesystem::create_directories(PROGRAM_CACHE_DIR);
+    std::string temp = path + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(temp, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write(binary.data(), length);
+    out.close();
+    if (!out || rename(temp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to cache program binary: " << path << std::endl;
+        std::remove(temp.c_str());
     }
 }
 
@@ -49,56 +96,89 @@ ShaderProgram::ShaderProgram(   const std::string& vertexFile,
     if ( load ) { Load(); };
 }
 void ShaderProgram::Load() {
-    GLuint vertexShader, geometryShader, fragmentShader;
+    PendingProgram pending = Begin();
+    if (Check(pending)) Adopt(pending);
+}
+PendingProgram ShaderProgram::Begin() const {
+    PendingProgram pending;
 	std::string vertexCode, geometryCode, fragmentCode;
+    try {
+                                vertexCode = preprocessShader(vertex_path, defines, pending.files[0]);
+        if (include_geometry)   geometryCode = preprocessShader(geometry_path, defines, pending.files[1]);
+	                            fragmentCode = preprocessShader(fragment_path, defines, pending.files[2]);
+    } catch (int) {
+        return pending; // A file mid-save, Check reports it and the running program stays
+    }
+    for (const std::vector<std::string>& files : pending.files) {
+        for (const std::string& file : files) {
+            if (std::find(pending.dependencies.begin(), pending.dependencies.end(), file) == pending.dependencies.end()) {
+                pending.dependencies.push_back(file);
+            }
+        }
+    }
 
-                            vertexCode = get_file_contents(vertex_path, "");
-    if (include_geometry)   geometryCode = get_file_contents(geometry_path, "");
-	                        fragmentCode = get_file_contents(fragment_path, "");
-
-	vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    const char* vertexSource = vertexCode.c_str();
-	glShaderSource(vertexShader, 1, &vertexSource, NULL);
-	glCompileShader(vertexShader);
-	checkCompileErrors(vertexShader, "VERTEX");
-
-    if (include_geometry) {
-        geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
-        const char* geometrySource = geometryCode.c_str();
-        glShaderSource(geometryShader, 1, &geometrySource, NULL);
-        glCompileShader(geometryShader);
-        checkCompileErrors(geometryShader, "GEOMETRY");
+    // A binary linked earlier from the same sources skips compiling altogether
+    pending.cachePath = programCachePath(vertexCode, geometryCode, fragmentCode);
+    pending.program = glCreateProgram();
+    if (!pending.cachePath.empty() && loadProgramBinary(pending.program, pending.cachePath)) {
+        pending.cached = true;
+        return pending;
     }
 
-	fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fragmentSource = fragmentCode.c_str();
-	glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-	glCompileShader(fragmentShader);
-	checkCompileErrors(fragmentShader, "FRAGMENT");
-
-	ID = glCreateProgram();
-	                        glAttachShader(ID, vertexShader);
-    if (include_geometry)   glAttachShader(ID, geometryShader);
-	                        glAttachShader(ID, fragmentShader);
-	glLinkProgram(ID);
-	checkLinkingErrors(ID);
-
-	glDeleteShader(vertexShader);
-    glDeleteShader(geometryShader);
-	glDeleteShader(fragmentShader);
+    // Nothing below waits on the driver: with parallel compile the link runs on its threads
+    const GLenum stages[3] = {GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER};
+    const std::string* codes[3] = {&vertexCode, &geometryCode, &fragmentCode};
+    for (int i = 0; i < 3; ++i) {
+        if (i == 1 && !include_geometry) continue;
+        pending.shaders[i] = glCreateShader(stages[i]);
+        const char* source = codes[i]->c_str();
+        glShaderSource(pending.shaders[i], 1, &source, NULL);
+        glCompileShader(pending.shaders[i]);
+        glAttachShader(pending.program, pending.shaders[i]);
+    }
+    if (!pending.cachePath.empty()) glProgramParameteri(pending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(pending.program);
+    return pending;
+}
+bool ShaderProgram::Check(PendingProgram& pending) const {
+    if (pending.program == 0) {
+        std::cout << "SHADER_SOURCE_ERROR for: " << fragment_path << std::endl;
+        return false;
+    }
+    const char* names[3] = {"VERTEX", "GEOMETRY", "FRAGMENT"};
+    bool linked = checkLinkingErrors(pending.program);
+    for (int i = 0; i < 3; ++i) {
+        if (pending.shaders[i] == 0) continue;
+        if (!linked) checkCompileErrors(pending.shaders[i], names[i], pending.files[i]);
+        glDeleteShader(pending.shaders[i]);
+        pending.shaders[i] = 0;
+    }
+    if (!linked) {
+        glDeleteProgram(pending.program);
+        pending.program = 0;
+        return false;
+    }
+    if (!pending.cached && !pending.cachePath.empty()) storeProgramBinary(pending.program, pending.cachePath);
+    return true;
+}
+void ShaderProgram::Adopt(PendingProgram& pending) {
+    if (ID != 0) glDeleteProgram(ID); // Earlier reloads leaked every replaced program
+    ID = pending.program;
+    dependencies.swap(pending.dependencies);
+    pending.program = 0;
 }
 void ShaderProgram::Activate() { glUseProgram(ID); }
 void ShaderProgram::Delete() { glDeleteProgram(ID); }
-void ShaderProgram::checkCompileErrors(unsigned int shader, const char* type) {
+void ShaderProgram::checkCompileErrors(unsigned int shader, const char* type, const std::vector<std::string>& files) const {
     GLint hasCompiled;
     char infoLog[1024];
     glGetShaderiv(shader, GL_COMPILE_STATUS, &hasCompiled);
     if (hasCompiled == GL_FALSE) {
         glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-        std::cout << "SHADER_COMPILATION_ERROR for: " << type << "\n" << infoLog << std::endl;
+        std::cout << "SHADER_COMPILATION_ERROR for: " << type << "\n" << annotateShaderLog(infoLog, files) << std::endl;
     }
 }
-void ShaderProgram::checkLinkingErrors(unsigned int program) {
+bool ShaderProgram::checkLinkingErrors(unsigned int program) const {
     GLint hasLinked;
     char infoLog[1024];
     glGetProgramiv(program, GL_LINK_STATUS, &hasLinked);
@@ -106,4 +186,36 @@ void ShaderProgram::checkLinkingErrors(unsigned int program) {
         glGetProgramInfoLog(program, 1024, NULL, infoLog);
         std::cout << "SHADER_LINKING_ERROR for: PROGRAM\n" << infoLog << std::endl;
     }
-}
\ No newline at end of file
+    return hasLinked == GL_TRUE;
+}
+
+ShaderVariants::ShaderVariants(const std::string& vertexFile, const std::string& geometryFile,
+                               const std::string& fragmentFile,
+                               const std::vector<std::vector<std::string>>& variantDefines,
+                               const std::vector<const char*>& uniformNames)
+        : uniform_names(uniformNames) {
+    for (const std::vector<std::string>& defines : variantDefines) {
+        programs.emplace_back(vertexFile, geometryFile, fragmentFile, false);
+        programs.back().defines = defines;
+    }
+    locations.assign(programs.size() * uniform_names.size(), -1);
+}
+
+void ShaderVariants::Load() {
+    for (ShaderProgram& program : programs) program.Load();
+    Locate();
+}
+
+void ShaderVariants::Locate() {
+    for (size_t v = 0; v < programs.size(); ++v) {
+        for (size_t u = 0; u < uniform_names.size(); ++u) {
+            locations[v * uniform_names.size() + u] = glGetUniformLocation(programs[v].ID, uniform_names[u]);
+        }
+    }
+}
+
+std::vector<ShaderProgram*> ShaderVariants::Programs() {
+    std::vector<ShaderProgram*> all;
+    for (ShaderProgram& program : programs) all.push_back(&program);
+    return all;
+}
@@ -1,18 +1,57 @@
 #include "graphicsPipe.h"
+#include "rendererHost.h"
 
 void ShaderInterface::compile() {
     // Base implementation - should be overridden
 }
 
+ShowParams::ShowParams(const UniformStructure& u)
+        : scale(u.scale), brightness(u.brightness), speed(u.speed), fov(u.fov),
+          hueShift(u.hueShift), vignette(u.vignette), linePx(u.linePx), lineFade(u.lineFade),
+          shatter(u.shatter), pad{0.0f, 0.0f, 0.0f} {
+    for (int i = 0; i < BAND_COUNT; i++) audio_bands[i] = u.audio_bands[i];
+}
+
+void ShaderInterface::openReplay() {
+    if (!clas.replayFile.empty()) replay.open(clas.replayFile);
+}
+
+bool ShaderInterface::pullParams(SharedUniforms& shared, float time) {
+    // A recording replaces select entirely, so every run sees the same parameter stream
+    if (replay.loaded()) return replay.advance(time, *shared.data);
+    return shared.Sync();
+}
+
+void ShaderInterface::initParams() {
+    params_ubo = UBO(nullptr, sizeof(ShowParams), GL_DYNAMIC_DRAW);
+    params_ubo.BindBase(PARAMS_BINDING);
+}
+
+bool ShaderInterface::attachParams(GLuint program) {
+    // GL 4.1 has no layout(binding), so every block starts at binding 0 until told otherwise
+    GLuint index = glGetUniformBlockIndex(program, "ShowParams");
+    if (index == GL_INVALID_INDEX) return false;
+    glUniformBlockBinding(program, index, PARAMS_BINDING);
+    return true;
+}
+
+void ShaderInterface::uploadParams(const UniformStructure& u) {
+    ShowParams params(u);
+    params_ubo.Update(&params, sizeof(ShowParams));
+}
+
 void ShaderInterface::render() {
     // Base implementation - should be overridden
 }
 
 GamePatterns::GamePatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w) {
-    world_shader = ShaderProgram(
+    world_shaders = ShaderVariants(
         SHADER_DIR "/world.vert",
         SHADER_DIR "/prune.geom", 
-        SHADER_DIR "/spell_dodecaplex.frag", false);
+        SHADER_DIR "/spell_dodecaplex.frag",
+        {{}, {"SPELL_CAST_MINING"}, {"SPELL_RELEASE_MINING"}},
+        {"u_resolution", "u_mouse", "u_scroll", "u_time",
+         "CAST_LIFE", "SPELL_LIFE", "SPELL_FOCUS", "SPELL_HEAD"});
     fx_shader = ShaderProgram(
         SHADER_DIR "/shrapnel.vert",
         SHADER_DIR "/prune.geom",
@@ -20,6 +59,15 @@ GamePatterns::GamePatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w) {
     gui_shader = ShaderProgram(
         SHADER_DIR "/book.vert",
         SHADER_DIR "/book.frag", false);
+    depth_shader = ShaderProgram(
+        SHADER_DIR "/world.vert",
+        SHADER_DIR "/prune.geom",
+        SHADER_DIR "/depth.frag", false);
+    // Where the driver has bindless textures, every program samples the material array through a handle
+    texture_library.bindless = TextureLibrary::bindlessSupported();
+    if (texture_library.bindless) {
+        for (ShaderProgram* program : watchedPrograms()) program->defines.push_back("BINDLESS_TEXTURES");
+    }
     
     player_context.initializeMapData();
     player_context.populateDodecaplexVAO();
@@ -31,38 +79,40 @@ GamePatterns::GamePatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w) {
 }
 
 void GamePatterns::compile() {
-    world_shader.Load();
-    world_shader.Activate();
-    
-    texture_library.linkPentagonLibrary(world_shader.ID);
-
-    U_RESOLUTION  = glGetUniformLocation(world_shader.ID, "u_resolution");
-    U_MOUSE       = glGetUniformLocation(world_shader.ID, "u_mouse");
-    U_SCROLL      = glGetUniformLocation(world_shader.ID, "u_scroll");
-    U_TIME        = glGetUniformLocation(world_shader.ID, "u_time");
-    U_CAST_LIFE   = glGetUniformLocation(world_shader.ID, "CAST_LIFE");
-    U_SPELL_LIFE  = glGetUniformLocation(world_shader.ID, "SPELL_LIFE");            
-    U_SPELL_FOCUS = glGetUniformLocation(world_shader.ID, "SPELL_FOCUS");
-    U_SPELL_HEAD  = glGetUniformLocation(world_shader.ID, "SPELL_HEAD");
-
+    world_shaders.Load();
     fx_shader.Load();
-    fx_shader.Activate();
+    gui_shader.Load();
+    depth_shader.Load();
+    locate();
+    // Frames of fixed timestep runs must match from the first one, so they wait for the textures
+    if (clas.fixedStep()) texture_library.finishLoading();
+}
+
+void GamePatterns::locate() {
+    world_shaders.Locate();
+    std::vector<GLuint> program_ids;
+    for (ShaderProgram* program : watchedPrograms()) program_ids.push_back(program->ID);
+    texture_library.linkMaterials(program_ids);
 
-    texture_library.linkPentagonLibrary(fx_shader.ID); 
     S_SPELL_LIFE  = glGetUniformLocation(fx_shader.ID, "SPELL_LIFE");            
     
-    gui_shader.Load();
-    gui_shader.Activate();
-    texture_library.linkGrimoireLibrary(gui_shader.ID);
-
     U_FLIP_PROGRESS = glGetUniformLocation(gui_shader.ID, "u_flip_progress");
     U_TIME_BOOK     = glGetUniformLocation(gui_shader.ID, "u_time");
 
     window_uniforms->player_context = &player_context;
 }
 
+std::vector<ShaderProgram*> GamePatterns::watchedPrograms() {
+    std::vector<ShaderProgram*> programs = world_shaders.Programs();
+    programs.push_back(&fx_shader);
+    programs.push_back(&gui_shader);
+    programs.push_back(&depth_shader);
+    return programs;
+}
+
 void GamePatterns::render() {
     float time = glfwGetTime();
+    texture_library.update();
 
     accountCameraControls(window_uniforms, cam);
 
@@ -70,29 +120,42 @@ void GamePatterns::render() {
     glBufferSubData(GL_UNIFORM_BUFFER, 0,                 sizeof(glm::mat4), &(cam.Projection)[0][0]);
     glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &(cam.Model)[0][0]);
 
-    world_shader.Activate();
-
-    glUniform2f(U_RESOLUTION,   window_uniforms->windWidth,
-                                window_uniforms->windHeight);
-    glUniform2f(U_MOUSE,        window_uniforms->mouseX,
-                                window_uniforms->mouseY);
-    glUniform1f(U_SCROLL,       window_uniforms->scroll);
-    glUniform1f(U_TIME, time);
-
-    subroutine_index = getSpellSubroutine(window_uniforms, grimoire, world_shader.ID);
-
-    glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 1, &subroutine_index);
-
-    glUniform1f(U_CAST_LIFE,    grimoire.active_spell->cast_life);
-    glUniform1f(U_SPELL_LIFE,   grimoire.active_spell->spell_life);
-    glUniform3f(U_SPELL_FOCUS,  grimoire.active_spell->spell_focus.x,
-                                grimoire.active_spell->spell_focus.y,
-                                grimoire.active_spell->spell_focus.z);
-    glUniform3f(U_SPELL_HEAD,   grimoire.active_spell->spell_head.x,
-                                grimoire.active_spell->spell_head.y,
-                                grimoire.active_spell->spell_head.z);
+    player_context.viewCells(cam.Model, cam.Projection,
+                             glm::vec2(window_uniforms->windWidth, window_uniforms->windHeight), 0.0f);
+
+    // Idle frames draw the plain walls, a spell frame only the program of its effect
+    int effect = getSpellEffect(window_uniforms, grimoire);
+
+    // A spell's shading is heavy enough that its frames lay down depth first, then shade only what
+    // survives the depth test
+    bool prepass = clas.depthPrepass && effect != SPELL_EMPTY;
+    if (prepass) {
+        depth_shader.Activate();
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        player_context.drawMainVAO(false);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthFunc(GL_LEQUAL);
+    }
+    world_shaders[effect].Activate();
+
+    glUniform2f(world_shaders.Location(effect, W_RESOLUTION),   window_uniforms->windWidth,
+                                                                window_uniforms->windHeight);
+    glUniform2f(world_shaders.Location(effect, W_MOUSE),        window_uniforms->mouseX,
+                                                                window_uniforms->mouseY);
+    glUniform1f(world_shaders.Location(effect, W_SCROLL),       window_uniforms->scroll);
+    glUniform1f(world_shaders.Location(effect, W_TIME), time);
+
+    glUniform1f(world_shaders.Location(effect, W_CAST_LIFE),    grimoire.active_spell->cast_life);
+    glUniform1f(world_shaders.Location(effect, W_SPELL_LIFE),   grimoire.active_spell->spell_life);
+    glUniform3f(world_shaders.Location(effect, W_SPELL_FOCUS),  grimoire.active_spell->spell_focus.x,
+                                                                grimoire.active_spell->spell_focus.y,
+                                                                grimoire.active_spell->spell_focus.z);
+    glUniform3f(world_shaders.Location(effect, W_SPELL_HEAD),   grimoire.active_spell->spell_head.x,
+                                                                grimoire.active_spell->spell_head.y,
+                                                                grimoire.active_spell->spell_head.z);
 
-    player_context.drawMainVAO();  // Now includes background quad prepended to VAO
+    player_context.drawMainVAO();
+    if (prepass) glDepthFunc(GL_LESS);
     
     fx_shader.Activate();
     glUniform1f(S_SPELL_LIFE,   grimoire.active_spell->spell_life);
@@ -103,43 +166,138 @@ void GamePatterns::render() {
     grimoire.drawGrimoireVAOs(U_FLIP_PROGRESS);
 }
 
-SpinPatterns::SpinPatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w) {
+// Renderers analyse audio themselves only when given a file or feature timeline; otherwise select feeds them
+static AudioNest* localAudio(const CLAs& c) {
+    AudioNest* nest = nullptr;
+    if (!c.featureFile.empty()) nest = new AudioNest(c.featureFile, c.audioFile, !c.offline);
+    else if (!c.audioFile.empty()) nest = new AudioNest(c.audioFile, !c.offline);
+    if (nest && c.impulseTest) nest->startImpulseTest();
+    return nest;
+}
+
+SpinPatterns::SpinPatterns(CLAs c, Uniforms* w, SharedAssets* a) : ShaderInterface(c, w),
+        shared_uniforms(false, c.group), assets(a) {
     spin_shader = ShaderProgram(
         SHADER_DIR "/spin.vert",
         SHADER_DIR "/spin.geom",
         SHADER_DIR "/spin.frag", false);
+    audio_nest = localAudio(clas);
+    if (clas.fixedStep()) srand(0); // Same map and spin seed on every benchmark run
     
-    player_context.initializeMapData();
-    player_context.populateDodecaplexVAO(RhombusPattern(WebType::DOUBLE_STAR, false), true);
+    if (assets) {
+        player_context.shareDodecaplexVAO(assets->spin_context);
+    } else {
+        player_context.initializeMapData();
+        player_context.populateDodecaplexVAO(RhombusPattern(WebType::DOUBLE_STAR, false), true);
+    }
 
     glGenBuffers(1, &U_GLOBAL);
     glBindBuffer(GL_UNIFORM_BUFFER, U_GLOBAL);
     glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, U_GLOBAL);
+    frame_ubo = UBO(nullptr, sizeof(SpinFrame), GL_DYNAMIC_DRAW);
+    frame_ubo.BindBase(FRAME_BINDING);
+    initParams();
+    openReplay();
 }
 
 void SpinPatterns::compile() {
-    spin_shader.Load();
+    if (!assets) {
+        spin_shader.Load();
+        locate();
+        return;
+    }
+    // The first compile of a hosted output adopts the shared program, a later one (space) asks the
+    // host to relink it for every output
+    std::lock_guard<std::mutex> lock(assets->program_lock);
+    if (program_generation == assets->program_generation) {
+        assets->reload_requested = true;
+    } else {
+        adoptShared();
+    }
+}
+
+void SpinPatterns::adoptShared() {
+    spin_shader = assets->spin_shader;
+    program_generation = assets->program_generation;
+    locate();
+}
+
+std::vector<ShaderProgram*> SpinPatterns::watchedPrograms() {
+    if (assets) return {}; // The host watches the shared program
+    return {&spin_shader};
+}
+
+void SpinPatterns::locate() {
     spin_shader.Activate();
 
-    U_RESOLUTION  = glGetUniformLocation(spin_shader.ID, "u_resolution");
-    U_MOUSE       = glGetUniformLocation(spin_shader.ID, "u_mouse");
-    U_SCROLL      = glGetUniformLocation(spin_shader.ID, "u_scroll");
-    U_TIME        = glGetUniformLocation(spin_shader.ID, "u_time");
-    U_BANDS       = glGetUniformLocation(spin_shader.ID, "u_audio_bands");
-    U_BRIGHTNESS  = glGetUniformLocation(spin_shader.ID, "u_brightness");
-    U_SCALE       = glGetUniformLocation(spin_shader.ID, "u_scale");
-    U_HUESHIFT    = glGetUniformLocation(spin_shader.ID, "u_hueShift");
-    U_VIGNETTE    = glGetUniformLocation(spin_shader.ID, "u_vignette");
-    U_LINE_PX     = glGetUniformLocation(spin_shader.ID, "u_linePx");
-    U_LINE_FADE   = glGetUniformLocation(spin_shader.ID, "u_lineFade");
-    U_SHATTER     = glGetUniformLocation(spin_shader.ID, "u_shatter");
+    GLuint frame = glGetUniformBlockIndex(spin_shader.ID, "SpinFrame");
+    if (frame != GL_INVALID_INDEX) glUniformBlockBinding(spin_shader.ID, frame, FRAME_BINDING);
+    if (!attachParams(spin_shader.ID)) {
+        std::cerr << "Spin shaders do not declare ShowParams, show parameters will not reach them.\n";
+    }
 
     window_uniforms->player_context = &player_context;
 }
 
+void SpinPatterns::waitForChange(int timeout_ms) {
+    if (!audio_nest) shared_uniforms.WaitForUpdate(timeout_ms);
+}
+
+// spin.vert's audio rotation, which comes before WORLD, so cells can be measured where they are drawn
+static glm::mat4 bandRotation(const float* audio_bands) {
+    float cx = std::cos(audio_bands[0]/200.0f), sx = std::sin(audio_bands[0]/200.0f);
+    float cy = std::cos(audio_bands[1]/200.0f), sy = std::sin(audio_bands[1]/200.0f);
+    float cz = std::cos(audio_bands[2]/200.0f), sz = std::sin(audio_bands[2]/200.0f);
+    float cw = std::cos(audio_bands[3]/200.0f), sw = std::sin(audio_bands[3]/200.0f);
+    glm::mat4 rotation = glm::mat4(1.0f);
+    rotation *= glm::mat4({
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f,   cx, 0.0f,   sx,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f,  -sx, 0.0f,   cx});
+    rotation *= glm::mat4({
+          cy, 0.0f, 0.0f,   sy,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+         -sy, 0.0f, 0.0f,   cy});
+    rotation *= glm::mat4({
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f,   cz,   sz,
+        0.0f, 0.0f,  -sz,   cz});
+    rotation *= glm::mat4({
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f,   cy,   sy, 0.0f,
+        0.0f,  -sy,   cy, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f});
+    rotation *= glm::mat4({
+          cz, 0.0f,  -sz, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+          sz, 0.0f,   cz, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f});
+    rotation *= glm::mat4({
+          cw,   sw, 0.0f, 0.0f,
+         -sw,   cw, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f});
+    return rotation;
+}
+
 void SpinPatterns::render() {
-    float time = glfwGetTime();
+    float time = window_uniforms->this_time;
+
+    // Shared parameters only need uploading when select published a change, local audio moved them
+    // or a parameter follows a curve
+    bool changed = pullParams(shared_uniforms, time);
+    changed |= shared_uniforms.SampleCurves(monotonicSeconds());
+    if (audio_nest) {
+        changed = true;
+        audio_nest->processFFT();
+        shared_uniforms.ApplyRouting(audio_nest->g_bandAmplitudes, time - window_uniforms->last_time);
+        shared_uniforms.StampLatency(audio_nest->channels[0]->capture_time, audio_nest->channels[0]->analysis_time,
+                                     audio_nest->channels[0]->impulses);
+    }
     
     accountSpin(window_uniforms, cam,   shared_uniforms.data->speed, 
                                         shared_uniforms.data->fov, 
@@ -149,48 +307,80 @@ void SpinPatterns::render() {
     glBufferSubData(GL_UNIFORM_BUFFER, 0,                 sizeof(glm::mat4), &(cam.Projection)[0][0]);
     glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &(cam.Model)[0][0]);
 
-    spin_shader.Activate();
-
-    glUniform2f(U_RESOLUTION,   window_uniforms->windWidth,
-                                window_uniforms->windHeight);
-    glUniform2f(U_MOUSE,        window_uniforms->mouseX,
-                                window_uniforms->mouseY);
-    glUniform1f(U_SCROLL,       window_uniforms->scroll);
-    glUniform1f(U_TIME, time);
-
-    glUniform4f(U_BANDS,    shared_uniforms.data->audio_bands[0],
-                            shared_uniforms.data->audio_bands[1],
-                            shared_uniforms.data->audio_bands[2],
-                            shared_uniforms.data->audio_bands[3]);
-
-    glUniform1f(U_BRIGHTNESS, shared_uniforms.data->brightness);
-    glUniform1f(U_SCALE,      shared_uniforms.data->scale);
-    glUniform1f(U_HUESHIFT,   shared_uniforms.data->hueShift);
-    glUniform1f(U_VIGNETTE,   shared_uniforms.data->vignette);
-    glUniform1f(U_LINE_PX,    shared_uniforms.data->linePx);
-    glUniform1f(U_LINE_FADE,  shared_uniforms.data->lineFade);
-    glUniform1f(U_SHATTER,    shared_uniforms.data->shatter);
-
+    SpinFrame frame = {{(float)window_uniforms->windWidth, (float)window_uniforms->windHeight},
+                       {(float)window_uniforms->mouseX, (float)window_uniforms->mouseY},
+                       (float)window_uniforms->scroll, time, {0.0f, 0.0f}};
+    frame_ubo.Update(&frame, sizeof(SpinFrame));
+
+    // Hosted outputs share the program but keep their frame values in their own buffers, so the lock
+    // only covers picking up a relinked program. Once current here, a program the host replaces
+    // meanwhile is not freed until this context lets go of it.
+    if (assets) {
+        std::lock_guard<std::mutex> lock(assets->program_lock);
+        if (program_generation != assets->program_generation) adoptShared();
+        spin_shader.Activate();
+    } else {
+        spin_shader.Activate();
+    }
+
+    if (changed) {
+        uploadParams(*shared_uniforms.data);
+        shared_uniforms.RecordUpload(latency);
+    }
+
+    player_context.viewCells(cam.Model*bandRotation(shared_uniforms.data->audio_bands), cam.Projection,
+                             glm::vec2(window_uniforms->windWidth, window_uniforms->windHeight),
+                             clas.webDetail);
     player_context.drawMainVAO();
 }
 
 // FragPatterns implementation
-FragPatterns::FragPatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w) {
+FragPatterns::FragPatterns(CLAs c, Uniforms* w) : ShaderInterface(c, w),
+        shared_uniforms(false, c.group) {
+    audio_nest = localAudio(clas);
     std::string fragShaderPath = clas.shaderPath.empty()
         ? std::string(FRAG_SHADER_DIR) + "/purple-vortex.frag"
         : clas.shaderPath;
     frag_shader = ShaderProgram(FRAG_SHADER_DIR "/rect.vert", fragShaderPath, false);
     fullscreenQuad = rasterPipeVAO();
+    initParams();
+    openReplay();
+
+    // Fixed timestep runs must render the same frames every time, so they only take a fixed scale
+    bool adaptive = clas.targetFps > 0.0f && !clas.fixedStep();
+    scaled = clas.renderScale > 0.0f || adaptive;
+    if (scaled) {
+        ResolutionSettings settings;
+        settings.fixed_scale = clas.renderScale;
+        if (adaptive) settings.target_fps = clas.targetFps;
+        settings.filter = clas.sharpen ? UpscaleFilter::SHARPEN : UpscaleFilter::BILINEAR;
+        settings.temporal = clas.temporal;
+        resolution.init(settings);
+    }
 }
 
 void FragPatterns::compile() {
     frag_shader.Load();
+    locate();
+}
+
+std::vector<ShaderProgram*> FragPatterns::watchedPrograms() {
+    if (scaled) return {&frag_shader, resolution.program()};
+    return {&frag_shader};
+}
+
+void FragPatterns::locate() {
+    if (scaled) resolution.locate();
     frag_shader.Activate();
+    reupload = true;
     
     U_RESOLUTION  = glGetUniformLocation(frag_shader.ID, "u_resolution");
     U_MOUSE       = glGetUniformLocation(frag_shader.ID, "u_mouse");
     U_SCROLL      = glGetUniformLocation(frag_shader.ID, "u_scroll");
     U_TIME        = glGetUniformLocation(frag_shader.ID, "u_time");
+
+    params_in_block = attachParams(frag_shader.ID);
+    if (params_in_block) return;
     U_SCALE       = glGetUniformLocation(frag_shader.ID, "u_scale");
     U_BRIGHTNESS  = glGetUniformLocation(frag_shader.ID, "u_brightness");
     U_SPEED       = glGetUniformLocation(frag_shader.ID, "u_speed");
@@ -199,28 +389,58 @@ void FragPatterns::compile() {
     U_AUDIO_BANDS = glGetUniformLocation(frag_shader.ID, "u_audio_bands");
 }
 
+void FragPatterns::waitForChange(int timeout_ms) {
+    if (!audio_nest) shared_uniforms.WaitForUpdate(timeout_ms);
+}
+
 void FragPatterns::render() {
-    float time = glfwGetTime();
+    float time = window_uniforms->this_time;
+
+    // Shared parameters only need uploading when select published a change, local audio moved them
+    // or a parameter follows a curve
+    bool changed = pullParams(shared_uniforms, time) || reupload;
+    changed |= shared_uniforms.SampleCurves(monotonicSeconds());
+    reupload = false;
+    if (audio_nest) {
+        changed = true;
+        audio_nest->processFFT();
+        shared_uniforms.ApplyRouting(audio_nest->g_bandAmplitudes, time - window_uniforms->last_time);
+        shared_uniforms.StampLatency(audio_nest->channels[0]->capture_time, audio_nest->channels[0]->analysis_time,
+                                     audio_nest->channels[0]->impulses);
+    }
     
+    unsigned int width = window_uniforms->windWidth, height = window_uniforms->windHeight;
+    if (scaled) {
+        resolution.begin(width, height);
+        width  = resolution.renderWidth;
+        height = resolution.renderHeight;
+    }
+
     frag_shader.Activate();
     
-    glUniform2f(U_RESOLUTION,   window_uniforms->windWidth,
-                                window_uniforms->windHeight);
+    glUniform2f(U_RESOLUTION,   width, height);
     glUniform2f(U_MOUSE,        window_uniforms->mouseX,
                                 window_uniforms->mouseY);
     glUniform1f(U_SCROLL,       window_uniforms->scroll);
     glUniform1f(U_TIME, time);
 
-    glUniform4f(U_AUDIO_BANDS,  shared_uniforms.data->audio_bands[0],
-                                shared_uniforms.data->audio_bands[1],
-                                shared_uniforms.data->audio_bands[2],
-                                shared_uniforms.data->audio_bands[3]);
-
-    glUniform1f(U_SCALE,      shared_uniforms.data->scale);
-    glUniform1f(U_BRIGHTNESS, shared_uniforms.data->brightness);
-    glUniform1f(U_SPEED,      shared_uniforms.data->speed);
-    glUniform1f(U_FOV,        shared_uniforms.data->fov);
-    glUniform1f(U_HUESHIFT,   shared_uniforms.data->hueShift);
+    if (changed && params_in_block) {
+        uploadParams(*shared_uniforms.data);
+        shared_uniforms.RecordUpload(latency);
+    } else if (changed) {
+        glUniform4f(U_AUDIO_BANDS,  shared_uniforms.data->audio_bands[0],
+                                    shared_uniforms.data->audio_bands[1],
+                                    shared_uniforms.data->audio_bands[2],
+                                    shared_uniforms.data->audio_bands[3]);
+        shared_uniforms.RecordUpload(latency);
+
+        glUniform1f(U_SCALE,      shared_uniforms.data->scale);
+        glUniform1f(U_BRIGHTNESS, shared_uniforms.data->brightness);
+        glUniform1f(U_SPEED,      shared_uniforms.data->speed);
+        glUniform1f(U_FOV,        shared_uniforms.data->fov);
+        glUniform1f(U_HUESHIFT,   shared_uniforms.data->hueShift);
+    }
 
     fullscreenQuad.DrawElements(GL_TRIANGLES);
+    if (scaled) resolution.end();
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+#include <mutex>
+#include <regex>
+#include <algorithm>
+#include "shaderPreprocessor.h"
+
+namespace fs = std::filesystem;
+
+// One file split into lines, includes already picked out
+struct ShaderFile {
+    fs::file_time_type modified;
+    std::vector<std::string> lines;
+    std::vector<std::string> includes; // Per line: the included path, empty for ordinary lines
+};
+
+// A line of the expanded source and where it came from
+struct SourceLine {
+    const std::string* text;
+    int file, line;
+};
+
+static std::mutex cache_mutex; // Background reloads preprocess off the render thread
+static std::unordered_map<std::string, std::shared_ptr<const ShaderFile>> file_cache;
+
+static std::string includeTarget(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0) return "";
+    start = line.find_first_not_of(" \t\"<", start + 8);
+    if (start == std::string::npos) return "";
+    size_t end = line.find_last_not_of(" \t\r\">");
+    return line.substr(start, end + 1 - start);
+}
+
+static std::shared_ptr<const ShaderFile> readShaderFile(const std::string& path) {
+    std::error_code error;
+    fs::file_time_type modified = fs::last_write_time(path, error);
+    if (error) {
+        std::cerr << "Error loading shader from: " << path << std::endl;
+        throw(errno ? errno : ENOENT);
+    }
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto cached = file_cache.find(path);
+        if (cached != file_cache.end() && cached->second->modified == modified) return cached->second;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error loading shader from: " << path << std::endl;
+        throw(errno);
+    }
+    auto file = std::make_shared<ShaderFile>();
+    file->modified = modified;
+    std::string line;
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        file->includes.push_back(includeTarget(line));
+        file->lines.push_back(std::move(line));
+    }
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    file_cache[path] = file;
+    return file;
+}
+
+static void expand(const std::string& path, std::vector<std::string>& files,
+                   std::vector<std::shared_ptr<const ShaderFile>>& held, std::vector<SourceLine>& out) {
+    std::string absolute = fs::absolute(path).lexically_normal().string();
+    if (std::find(files.begin(), files.end(), absolute) != files.end()) return; // Already included
+    int index = files.size();
+    files.push_back(absolute);
+    held.push_back(readShaderFile(absolute));
+    const ShaderFile& file = *held.back();
+
+    std::string dir = fs::path(absolute).parent_path().string();
+    for (size_t i = 0; i < file.lines.size(); ++i) {
+        if (file.includes[i].empty()) {
+            out.push_back({&file.lines[i], index, (int)i + 1});
+        } else {
+            expand(dir + "/" + file.includes[i], files, held, out);
+        }
+    }
+}
+
+static bool isVersion(const std::string& line) {
+    size_t start = line.find_first_not_of(" \t");
+    return start != std::string::npos && line.compare(start, 8, "#version") == 0;
+}
+
+std::string preprocessShader(const std::string& path, const std::vector<std::string>& defines,
+                             std::vector<std::string>& files) {
+    files.clear();
+    std::vector<std::shared_ptr<const ShaderFile>> held; // Keeps the lines alive if the cache moves on
+    std::vector<SourceLine> lines;
+    expand(path, files, held, lines);
+
+    size_t bytes = 0;
+    for (const SourceLine& l : lines) bytes += l.text->size() + 1;
+    std::string source;
+    source.reserve(bytes + 64 * (defines.size() + files.size()));
+
+    auto version = std::find_if(lines.begin(), lines.end(), [](const SourceLine& l) { return isVersion(*l.text); });
+    if (version != lines.end()) source.append(*version->text).append("\n");
+    for (const std::string& define : defines) source.append("#define ").append(define).append("\n");
+
+    // GLSL 3.30 on: "#line n s" makes the next line number n of source string s
+    int file = -1, next = 0;
+    for (auto it = lines.begin(); it != lines.end(); ++it) {
+        if (it == version) continue;
+        if (it->file != file || it->line != next) {
+            source.append("#line ").append(std::to_string(it->line)).append(" ").append(std::to_string(it->file)).append("\n");
+            file = it->file;
+        }
+        source.append(*it->text).append("\n");
+        next = it->line + 1;
+    }
+    return source;
+}
+
+std::string annotateShaderLog(const std::string& log, const std::vector<std::string>& files) {
+    // Drivers lead with the source string: "0:12(5):" (Mesa), "0(12) :" (NVIDIA), "ERROR: 0:12:" (AMD)
+    static const std::regex location("(\\d+)([:(]\\d+)");
+    std::string annotated;
+    std::istringstream in(log);
+    std::string line;
+    while (getline(in, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, location)) {
+            size_t index = std::stoul(match[1].str());
+            if (index < files.size()) {
+                line = match.prefix().str() + fs::path(files[index]).filename().string() + match[2].str() + match.suffix().str();
+            }
+        }
+        annotated.append(line).append("\n");
+    }
+    return annotated;
+}
@@ -0,0 +1,164 @@
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+#include <filesystem>
+#include <algorithm>
+#include "shaderWatcher.h"
+
+// GL_KHR_parallel_shader_compile, newer than the loader
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (*MaxShaderCompilerThreadsProc)(GLuint count);
+
+ShaderWatcher::ShaderWatcher(GLFWwindow* share) {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd == -1) std::cerr << "Shader files will not be watched: inotify unavailable" << std::endl;
+
+    // Some platforms hand out entry points for anything, so the extension string decides
+    const char* extensions[2] = {"GL_KHR_parallel_shader_compile", "GL_ARB_parallel_shader_compile"};
+    const char* entries[2]    = {"glMaxShaderCompilerThreadsKHR", "glMaxShaderCompilerThreadsARB"};
+    for (int i = 0; i < 2 && !parallel; ++i) {
+        if (!glfwExtensionSupported(extensions[i])) continue;
+        MaxShaderCompilerThreadsProc threads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress(entries[i]);
+        if (threads) threads(0xFFFFFFFFu); // As many as the driver likes
+        parallel = true;
+    }
+    if (parallel) return;
+
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    compile_context = glfwCreateWindow(1, 1, "shader compiler", nullptr, share);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (!compile_context) {
+        std::cerr << "No context to compile shaders in the background, reloads will block" << std::endl;
+        return;
+    }
+    worker = std::thread(&ShaderWatcher::compileLoop, this);
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+    if (compile_context) glfwDestroyWindow(compile_context);
+    if (inotify_fd != -1) close(inotify_fd);
+}
+
+void ShaderWatcher::watch(ShaderProgram* program) {
+    if (std::find(programs.begin(), programs.end(), program) != programs.end()) return;
+    programs.push_back(program);
+    watchDirectories(program);
+}
+
+void ShaderWatcher::watchDirectories(const ShaderProgram* program) {
+    if (inotify_fd == -1) return;
+    for (const std::string& file : program->dependencies) {
+        std::string dir = std::filesystem::path(file).parent_path().string();
+        // Editors often save by renaming a new file over the old one, so the directory is watched
+        int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd != -1) directories[wd] = dir;
+    }
+}
+
+void ShaderWatcher::reloadAll() {
+    for (ShaderProgram* program : programs) request(program);
+}
+
+void ShaderWatcher::request(ShaderProgram* program) {
+    if (busy.count(program)) {
+        stale.insert(program);
+        return;
+    }
+    if (parallel) {
+        busy.insert(program);
+        in_flight.push_back({program, program->Begin()});
+    } else if (compile_context) {
+        busy.insert(program);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            to_link.push_back({program});
+        }
+        wake.notify_one();
+    } else {
+        program->Load();
+    }
+}
+
+bool ShaderWatcher::poll() {
+    // Changed files, then every program built from one of them
+    if (inotify_fd != -1) {
+        alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+        ssize_t length;
+        std::set<ShaderProgram*> changed;
+        while ((length = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                inotify_event* event = (inotify_event*)p;
+                p += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || !directories.count(event->wd)) continue;
+                std::string file = directories[event->wd] + "/" + event->name;
+                for (ShaderProgram* program : programs) {
+                    const std::vector<std::string>& files = program->dependencies;
+                    if (std::find(files.begin(), files.end(), file) != files.end()) changed.insert(program);
+                }
+            }
+        }
+        for (ShaderProgram* program : changed) request(program);
+    }
+
+    std::vector<Job> done;
+    for (auto it = in_flight.begin(); it != in_flight.end();) {
+        GLint complete = GL_TRUE;
+        if (it->pending.program) glGetProgramiv(it->pending.program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (!complete) {
+            ++it;
+            continue;
+        }
+        it->linked = it->program->Check(it->pending);
+        done.push_back(std::move(*it));
+        it = in_flight.erase(it);
+    }
+    if (compile_context) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Job& job : linked) done.push_back(std::move(job));
+        linked.clear();
+    }
+
+    bool replaced = false;
+    for (Job& job : done) {
+        ShaderProgram* program = job.program;
+        busy.erase(program);
+        if (job.linked) {
+            program->Adopt(job.pending);
+            watchDirectories(program); // A new include may live elsewhere
+            replaced = true;
+            std::cout << "Reloaded " << program->fragment_path << std::endl;
+        } else {
+            std::cout << "Keeping the previous program for " << program->fragment_path << std::endl;
+        }
+        if (stale.erase(program)) request(program);
+    }
+    return replaced;
+}
+
+void ShaderWatcher::compileLoop() {
+    glfwMakeContextCurrent(compile_context);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !to_link.empty(); });
+        if (stopping) break;
+        Job job = std::move(to_link.front());
+        to_link.erase(to_link.begin());
+        lock.unlock();
+
+        job.pending = job.program->Begin();
+        job.linked = job.program->Check(job.pending);
+        glFinish(); // The program must be complete before another context uses it
+
+        lock.lock();
+        linked.push_back(std::move(job));
+    }
+    glfwMakeContextCurrent(nullptr);
+}
@@ -153,8 +153,8 @@ VAO sigilToVAO(Sigil sigil) {
         sigil_verts[w++] = sigil.verts[i*2];
         sigil_verts[w++] = sigil.verts[i*2+1];
         sigil_verts[w++] = pageDepth(sigil.verts[i*2]);
-        sigil_verts[w++] = sigil.verts[i*2]/2.0f;
-        sigil_verts[w++] = sigil.verts[i*2+1]/2.0f;
+        sigil_verts[w++] = sigil.verts[i*2];   // The ink material maps these into its corner
+        sigil_verts[w++] = sigil.verts[i*2+1];
         sigil_verts[w++] = 2.0f;
     }
     return VAO(sigil_verts, sizeof(sigil_verts), sigil.indeces, sigil.indx_len*sizeof(GLuint));
@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stb/stb_image.h>
+#include "textureCache.h"
+
+#define COMPRESSED_RGBA_S3TC_DXT5 0x83F3 // EXT_texture_compression_s3tc, not in the core loader
+
+bool TextureArrayFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false; // Not converted yet
+    struct stat info;
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(TextureCacheHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* m = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (m == MAP_FAILED) {
+        std::cerr << "Failed to map texture cache: " << path << "\n";
+        return false;
+    }
+
+    const TextureCacheHeader* h = (const TextureCacheHeader*)m;
+    size_t table = sizeof(TextureCacheHeader) + (size_t)h->levels * sizeof(uint32_t);
+    bool valid = h->magic == TEXTURE_CACHE_MAGIC && h->version == TEXTURE_CACHE_VERSION
+              && h->levels > 0 && h->levels <= 32 && (size_t)info.st_size >= table;
+    const uint32_t* bytes = (const uint32_t*)(h + 1);
+    size_t expected = table;
+    for (uint32_t i = 0; valid && i < h->levels; i++) expected += bytes[i];
+    if (!valid || (size_t)info.st_size < expected) {
+        std::cerr << "Invalid texture cache: " << path << "\n";
+        munmap(m, info.st_size);
+        return false;
+    }
+
+    map = m;
+    mapped_size = info.st_size;
+    image.format = h->format;
+    image.width  = h->width;
+    image.height = h->height;
+    image.layers = h->layers;
+    const unsigned char* data = (const unsigned char*)m + table;
+    for (uint32_t i = 0; i < h->levels; i++) {
+        image.levels.push_back(data);
+        image.level_bytes.push_back(bytes[i]);
+        data += bytes[i];
+    }
+    return true;
+}
+
+void TextureArrayFile::close() {
+    if (!map) return;
+    munmap(map, mapped_size);
+    map = nullptr;
+    mapped_size = 0;
+    image = TextureArrayImage();
+}
+
+GLenum preferredTextureFormat() {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+    std::vector<GLint> formats(count);
+    if (count) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    for (GLenum wanted : {(GLenum)GL_COMPRESSED_RGBA_BPTC_UNORM, (GLenum)COMPRESSED_RGBA_S3TC_DXT5}) {
+        if (std::find(formats.begin(), formats.end(), (GLint)wanted) != formats.end()) return wanted;
+    }
+    return GL_RGBA8;
+}
+
+std::string textureCachePath(const char* paths[], int count, GLenum format) {
+    // FNV-1a over each image's path, size and modification time, so editing an image rebuilds its array
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void* p, size_t n) {
+        const unsigned char* s = (const unsigned char*)p;
+        for (size_t i = 0; i < n; ++i) {
+            hash ^= s[i];
+            hash *= 0x100000001b3ull;
+        }
+    };
+    uint32_t version = TEXTURE_CACHE_VERSION;
+    mix(&version, sizeof(version));
+    mix(&format, sizeof(format));
+    for (int i = 0; i < count; i++) {
+        mix(paths[i], strlen(paths[i]) + 1);
+        struct stat info;
+        if (stat(paths[i], &info) == 0) {
+            int64_t stamp[2] = {(int64_t)info.st_size, (int64_t)info.st_mtime};
+            mix(stamp, sizeof(stamp));
+        }
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.tex", (unsigned long long)hash);
+    return std::string(TEXTURE_CACHE_DIR) + "/" + name;
+}
+
+// One layer of the next mip level, each texel the average of the (up to) four below it
+static void downsample(const unsigned char* in, unsigned char* out, int w, int h) {
+    int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+    for (int y = 0; y < nh; y++) {
+        int y0 = std::min(2 * y, h - 1), y1 = std::min(2 * y + 1, h - 1);
+        for (int x = 0; x < nw; x++) {
+            int x0 = std::min(2 * x, w - 1), x1 = std::min(2 * x + 1, w - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = in[(y0 * w + x0) * 4 + c] + in[(y0 * w + x1) * 4 + c]
+                        + in[(y1 * w + x0) * 4 + c] + in[(y1 * w + x1) * 4 + c];
+                out[(y * nw + x) * 4 + c] = (sum + 2) / 4;
+            }
+        }
+    }
+}
+
+// One image at another size, bilinear between texel centres and clamped at the edges, so a smaller
+// image fills its whole layer and mips never blend it with anything but itself
+static void resample(const unsigned char* in, int w, int h, unsigned char* out, int nw, int nh) {
+    for (int y = 0; y < nh; y++) {
+        float fy = std::min(std::max((y + 0.5f) * h / nh - 0.5f, 0.0f), (float)(h - 1));
+        int y0 = (int)fy, y1 = std::min(y0 + 1, h - 1);
+        float ty = fy - y0;
+        for (int x = 0; x < nw; x++) {
+            float fx = std::min(std::max((x + 0.5f) * w / nw - 0.5f, 0.0f), (float)(w - 1));
+            int x0 = (int)fx, x1 = std::min(x0 + 1, w - 1);
+            float tx = fx - x0;
+            for (int c = 0; c < 4; c++) {
+                float top    = in[(y0 * w + x0) * 4 + c] + tx * (in[(y0 * w + x1) * 4 + c] - in[(y0 * w + x0) * 4 + c]);
+                float bottom = in[(y1 * w + x0) * 4 + c] + tx * (in[(y1 * w + x1) * 4 + c] - in[(y1 * w + x0) * 4 + c]);
+                out[(y * nw + x) * 4 + c] = (unsigned char)(top + ty * (bottom - top) + 0.5f);
+            }
+        }
+    }
+}
+
+bool decodeTextureArray(const std::vector<std::string>& paths, TextureArrayImage& image,
+                        std::vector<std::vector<unsigned char>>& storage, WorkerPool& pool) {
+    int count = paths.size();
+    storage.clear();
+    image = TextureArrayImage();
+    image.layers = count;
+
+    // The first image sets the size of the array, so it is decoded before the others
+    std::vector<unsigned char*> decoded(count, nullptr);
+    std::vector<int> widths(count), heights(count);
+    auto decode = [&](int i) {
+        int channels;
+        decoded[i] = stbi_load(paths[i].c_str(), &widths[i], &heights[i], &channels, STBI_rgb_alpha);
+    };
+    decode(0);
+    pool.run(count - 1, [&](int i) { decode(i + 1); });
+
+    bool complete = true;
+    for (int i = 0; i < count; i++) {
+        if (decoded[i]) continue;
+        std::cerr << "Missing texture image file: " << paths[i] << "\n";
+        complete = false;
+    }
+    if (complete) {
+        image.width  = widths[0];
+        image.height = heights[0];
+        storage.emplace_back((size_t)image.width * image.height * count * 4);
+        pool.run(count, [&](int i) {
+            unsigned char* layer = storage[0].data() + (size_t)i * image.width * image.height * 4;
+            if (widths[i] == image.width && heights[i] == image.height) {
+                memcpy(layer, decoded[i], (size_t)image.width * image.height * 4);
+            } else {
+                resample(decoded[i], widths[i], heights[i], layer, image.width, image.height);
+            }
+        });
+    }
+    for (unsigned char* img_data : decoded) stbi_image_free(img_data);
+    if (!complete) return false;
+
+    int w = image.width, h = image.height;
+    while (w > 1 || h > 1) {
+        int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+        storage.emplace_back((size_t)nw * nh * count * 4);
+        const unsigned char* src = storage[storage.size() - 2].data();
+        unsigned char* dst = storage.back().data();
+        pool.run(count, [&](int i) {
+            downsample(src + (size_t)i * w * h * 4, dst + (size_t)i * nw * nh * 4, w, h);
+        });
+        w = nw;
+        h = nh;
+    }
+    for (std::vector<unsigned char>& level : storage) {
+        image.levels.push_back(level.data());
+        image.level_bytes.push_back(level.size());
+    }
+    return true;
+}
+
+void encodeTextureArray(GLenum format, TextureArrayImage& image, std::vector<std::vector<unsigned char>>& storage) {
+    // The driver encodes on upload and hands the blocks back; if it would not, the array stays raw
+    GLuint scratch;
+    glGenTextures(1, &scratch);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, scratch);
+    std::vector<std::vector<unsigned char>> encoded;
+    int w = image.width, h = image.height;
+    for (size_t level = 0; level < storage.size(); level++) {
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, w, h, image.layers, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, storage[level].data());
+        GLint compressed = GL_FALSE, size = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, level, GL_TEXTURE_COMPRESSED, &compressed);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+        if (!compressed || size <= 0) break;
+        encoded.emplace_back(size);
+        glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, level, encoded.back().data());
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    glDeleteTextures(1, &scratch);
+    if (encoded.size() != storage.size()) {
+        std::cerr << "Driver could not compress a texture array, it stays uncompressed\n";
+        return;
+    }
+    storage.swap(encoded);
+    image.format = format;
+    for (size_t level = 0; level < storage.size(); level++) {
+        image.levels[level] = storage[level].data();
+        image.level_bytes[level] = storage[level].size();
+    }
+}
+
+bool writeTextureArray(const std::string& path, const TextureArrayImage& image) {
+    TextureCacheHeader header;
+    header.magic   = TEXTURE_CACHE_MAGIC;
+    header.version = TEXTURE_CACHE_VERSION;
+    header.format  = image.format;
+    header.width   = image.width;
+    header.height  = image.height;
+    header.layers  = image.layers;
+    header.levels  = image.levels.size();
+
+    // Renderers launched together may all convert at once: each writes its own file and renames it in
+    std::filesystem::create_directories(TEXTURE_CACHE_DIR);
+    std::string temp = path + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(temp, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)image.level_bytes.data(), image.level_bytes.size() * sizeof(uint32_t));
+    for (size_t i = 0; i < image.levels.size(); i++) out.write((const char*)image.levels[i], image.level_bytes[i]);
+    out.close();
+    if (!out || rename(temp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to cache texture array: " << path << "\n";
+        std::remove(temp.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include "textureStreamer.h"
+
+TextureStreamer::TextureStreamer() : decoders(std::max(1, (int)std::thread::hardware_concurrency() - 2)) {
+    loader = std::thread(&TextureStreamer::loadLoop, this);
+}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    loader.join();
+}
+
+void TextureStreamer::load(StreamedTexture* texture, const char* paths[], int count, GLenum format) {
+    if (!texture->id) {
+        // Mid grey until the array arrives: a single layer, which every layer index clamps to
+        const unsigned char grey[4] = {128, 128, 128, 255};
+        glGenTextures(1, &texture->id);
+        glActiveTexture(GL_TEXTURE0 + texture->unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture->id);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    std::unique_ptr<Job> job = std::make_unique<Job>();
+    job->texture = texture;
+    job->paths.assign(paths, paths + count);
+    job->format = format;
+    job->cache_path = textureCachePath(paths, count, format);
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void TextureStreamer::loadLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !queued.empty(); });
+        if (stopping) return;
+        std::unique_ptr<Job> job = std::move(queued.front());
+        queued.pop_front();
+        lock.unlock();
+
+        if (job->cached.open(job->cache_path)) {
+            job->image = job->cached.image;
+        } else {
+            job->failed = !decodeTextureArray(job->paths, job->image, job->storage, decoders);
+        }
+
+        lock.lock();
+        loaded.push_back(std::move(job));
+    }
+}
+
+void TextureStreamer::allocate(Job& job) {
+    // First run only: the driver compresses on this thread, and the result is cached for next time
+    glActiveTexture(GL_TEXTURE0 + STREAM_UNIT);
+    if (!job.cached.map) {
+        if (job.format != GL_RGBA8) encodeTextureArray(job.format, job.image, job.storage);
+        writeTextureArray(job.cache_path, job.image);
+    }
+
+    const TextureArrayImage& image = job.image;
+    glGenTextures(1, &job.id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, job.id);
+    int w = image.width, h = image.height;
+    for (size_t level = 0; level < image.levels.size(); level++) {
+        if (image.format == GL_RGBA8) {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, w, h, image.layers, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        } else {
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, image.format, w, h, image.layers, 0,
+                                   image.level_bytes[level], NULL);
+        }
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, image.levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+bool TextureStreamer::stream(Job& job, size_t& budget) {
+    const TextureArrayImage& image = job.image;
+    glActiveTexture(GL_TEXTURE0 + STREAM_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, job.id);
+    while (job.level < image.levels.size()) {
+        size_t bytes = image.level_bytes[job.level] / image.layers;
+        if (bytes > budget && budget < UPLOAD_BYTES_PER_FRAME) return false;
+
+        // A buffer the GPU may still be reading from waits for a later frame rather than stalling this one
+        int slot = pbo_next;
+        if (fence[slot]) {
+            if (glClientWaitSync(fence[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) return false;
+            glDeleteSync(fence[slot]);
+            fence[slot] = 0;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[slot]);
+        if (pbo_size[slot] < (GLsizeiptr)bytes) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            pbo_size[slot] = bytes;
+        }
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!mapped) return false;
+        memcpy(mapped, image.levels[job.level] + job.layer * bytes, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        int w = std::max(1, image.width >> job.level), h = std::max(1, image.height >> job.level);
+        if (image.format == GL_RGBA8) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, job.level, 0, 0, job.layer, w, h, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        } else {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, job.level, 0, 0, job.layer, w, h, 1,
+                                      image.format, bytes, (void*)0);
+        }
+        fence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pbo_next = (slot + 1) % PBO_RING;
+        budget -= std::min(budget, bytes);
+
+        if (++job.layer == image.layers) {
+            job.layer = 0;
+            job.level++;
+        }
+    }
+    return true;
+}
+
+void TextureStreamer::swapIn(Job& job) {
+    StreamedTexture* texture = job.texture;
+    glActiveTexture(GL_TEXTURE0 + texture->unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, job.id);
+    glDeleteTextures(1, &texture->id);
+    texture->id = job.id;
+    texture->resident = true;
+}
+
+void TextureStreamer::poll() {
+    if (!pending) return;
+    if (!pbo[0]) glGenBuffers(PBO_RING, pbo);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!loaded.empty()) {
+            uploading.push_back(std::move(loaded.front()));
+            loaded.pop_front();
+            Job& job = *uploading.back();
+            if (job.failed) {
+                std::cerr << "Texture array " << job.paths[0] << " failed to load, its placeholder stays" << std::endl;
+                uploading.pop_back();
+                pending--;
+            }
+        }
+    }
+
+    // Arrays finish in the order they were requested
+    size_t budget = UPLOAD_BYTES_PER_FRAME;
+    while (!uploading.empty() && budget > 0) {
+        Job& job = *uploading.front();
+        if (!job.id) allocate(job);
+        if (!stream(job, budget)) break;
+        swapIn(job);
+        uploading.pop_front();
+        pending--;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void TextureStreamer::finish() {
+    while (!idle()) {
+        poll();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
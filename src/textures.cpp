@@ -1,50 +1,67 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "textures.h"
 #include <iostream>
+#include <GLFW/glfw3.h>
 
-void TextureLibrary::readRGBATextureArray(const char* paths[], int num_imgs, int prog_index) {
-    GLuint textureArrayID;
-    glGenTextures(1, &textureArrayID);
-    glActiveTexture(GL_TEXTURE0+prog_index);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayID);
-    
-    int width, height, channels;
-    unsigned char* img_data;
-    for (int i = 0; i < num_imgs; i++) {
-        img_data = stbi_load(paths[i], &width, &height, &channels, STBI_rgb_alpha);
-        if (!img_data) throw std::runtime_error("Missing texture image file");
-        if (!i) glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, num_imgs, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, img_data);
-        stbi_image_free(img_data);
-        img_data = NULL; // Ensures catching of failed loads.
+// ARB_bindless_texture, which the core loader leaves out
+typedef GLuint64 (APIENTRYP GetTextureHandle)(GLuint texture);
+typedef void (APIENTRYP MakeTextureHandleResident)(GLuint64 handle);
+typedef void (APIENTRYP ProgramUniformHandle)(GLuint program, GLint location, GLuint64 value);
+
+bool TextureLibrary::bindlessSupported() {
+    return glfwExtensionSupported("GL_ARB_bindless_texture");
+}
+
+void TextureLibrary::loadMaterials() {
+    MaterialTable table = {};
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        table.materials[m][0] = material_layers[m][0];
+        table.materials[m][1] = material_layers[m][1];
     }
-    
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    material_ubo = UBO((GLfloat*)&table, sizeof(MaterialTable));
+    material_ubo.BindBase(MATERIALS_BINDING);
+
+    streamer.load(&material_array, layer_paths, LAYER_COUNT, compress ? preferredTextureFormat() : GL_RGBA8);
 }
 
-void TextureLibrary::linkPentagonLibrary(GLuint shaderID) {
-    GLuint location;
-    
-    readRGBATextureArray(pentagon_paths, PENT_COUNT, 0);
-    location = glGetUniformLocation(shaderID, "pentagonTextures");        
-    glUniform1i(location, 0);
+void TextureLibrary::linkSampler(GLuint program) {
+    GLuint index = glGetUniformBlockIndex(program, "Materials");
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, MATERIALS_BINDING);
 
-    readRGBATextureArray(specular_paths, SPEC_COUNT, 1);
-    location = glGetUniformLocation(shaderID, "specularTextures");
-    glUniform1i(location, 1);
+    GLint location = glGetUniformLocation(program, "materialTextures");
+    if (!bindless) {
+        glProgramUniform1i(program, location, MATERIAL_UNIT);
+    } else if (handle) {
+        static ProgramUniformHandle programUniformHandle =
+            (ProgramUniformHandle)glfwGetProcAddress("glProgramUniformHandleui64ARB");
+        programUniformHandle(program, location, handle);
+    }
+}
+
+void TextureLibrary::linkMaterials(const std::vector<GLuint>& program_ids) {
+    programs = program_ids;
+    if (!material_array.id) loadMaterials();
+    if (bindless) update();
+    for (GLuint program : programs) linkSampler(program);
+}
 
-    readRGBATextureArray(spell_paths, 1, 3);
-    location = glGetUniformLocation(shaderID, "spellTextures");
-    glUniform1i(location, 3);
+void TextureLibrary::update() {
+    streamer.poll();
+    if (!bindless || handle_id == material_array.id) return;
 
+    // The placeholder, then each array swapped in, gets a handle of its own. The texture a previous
+    // handle belonged to is already deleted, which released that handle with it.
+    static GetTextureHandle getTextureHandle =
+        (GetTextureHandle)glfwGetProcAddress("glGetTextureHandleARB");
+    static MakeTextureHandleResident makeResident =
+        (MakeTextureHandleResident)glfwGetProcAddress("glMakeTextureHandleResidentARB");
+    handle = getTextureHandle(material_array.id);
+    makeResident(handle);
+    handle_id = material_array.id;
+    for (GLuint program : programs) linkSampler(program);
 }
 
-void TextureLibrary::linkGrimoireLibrary(GLuint shaderID) {
-    GLuint location;
-    readRGBATextureArray(grimoire_paths, BOOK_COUNT, 2);
-    location = glGetUniformLocation(shaderID, "grimoireTextures");
-    glUniform1i(location, 2);
-}
\ No newline at end of file
+void TextureLibrary::finishLoading() {
+    streamer.finish();
+    update();
+}
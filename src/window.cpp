@@ -1,7 +1,7 @@
 #include <iostream>
 #include "window.h"
 
-GLFWwindow* simplestWindow(unsigned int width, unsigned int height, const char* title){
+GLFWwindow* simplestWindow(unsigned int width, unsigned int height, const char* title, GLFWwindow* share){
         
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW\n";
@@ -12,7 +12,7 @@ GLFWwindow* simplestWindow(unsigned int width, unsigned int height, const char*
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow* window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(width, height, title, nullptr, share);
 
     if (!window) {
         std::cerr << "Failed to create GLFW window\n";
@@ -0,0 +1,57 @@
+#include "workerPool.h"
+
+WorkerPool::WorkerPool(int thread_count) {
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(&WorkerPool::loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void WorkerPool::run(int count, const std::function<void(int)>& fn) {
+    if (threads.empty() || count <= 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    job      = &fn;
+    total    = count;
+    next     = 0;
+    finished = 0;
+    generation++;
+    wake.notify_all();
+
+    drain(lock);
+    done.wait(lock, [&] { return finished == total; });
+    job = nullptr;
+}
+
+void WorkerPool::drain(std::unique_lock<std::mutex>& lock) {
+    // Claims jobs under the lock, runs them without it.
+    while (job && next < total) {
+        int index = next++;
+        const std::function<void(int)>* fn = job;
+        lock.unlock();
+        (*fn)(index);
+        lock.lock();
+        if (++finished == total) done.notify_all();
+    }
+}
+
+void WorkerPool::loop() {
+    unsigned seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) return;
+        seen = generation;
+        drain(lock);
+    }
+}
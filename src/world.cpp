@@ -122,7 +122,7 @@ PlayerContext::PlayerContext() {
     srand(time(NULL)); // Randomize the map...
     
     size_t vertex_max_size = 120*12*normal_web.vertex_count*VERT_ELEM_COUNT*sizeof(GLfloat);
-    size_t index_max_size  = 120*12*normal_web.index_count*sizeof(GLuint);
+    size_t index_max_size  = 120*12*(normal_web.index_count+normal_web.pentagon_indeces.size())*sizeof(GLuint);
     
     dodecaplex_buffers = CPUBufferPair(vertex_max_size, index_max_size);
 };
@@ -141,7 +141,6 @@ void PlayerContext::populateDodecaplexVAO() {
 };
   
 void PlayerContext::populateDodecaplexVAO(RhombusPattern web_pattern, bool include_normals){    
-    int* surface_ptr;
     dodecaplex_buffers.reset();
 
     const float FLAG_W = -999.0f;
@@ -161,17 +160,37 @@ void PlayerContext::populateDodecaplexVAO(RhombusPattern web_pattern, bool inclu
     dodecaplex_buffers.i_head = 6;
     dodecaplex_buffers.offset = 4;
 
-    for (SubSurface surface : map_data.adjacent_surfaces) {
-        surface_ptr = surface.indeces_ptr;
-        for (int f = 0; f < surface.num_faces; f++) {
-            PentagonMemory& memory = map_data.pentagons[*surface_ptr++];
-            memory.markStart(dodecaplex_buffers);
-            web_pattern.buildArrays(dodecaplex_buffers, memory, include_normals);
-            memory.markEnd(dodecaplex_buffers);
+    // Pentagons are keyed by side, so each cell's sides are written together
+    cell_draws.clear();
+    for (auto& side : map_data.pentagons) {
+        PentagonMemory& memory = side.second;
+        if (cell_draws.empty() || cell_draws.back().cell != side.first/SIDES) {
+            cell_draws.push_back(CellDraw(side.first/SIDES));
+            cell_draws.back().first[FULL_WEB] = dodecaplex_buffers.i_head;
         }
+        CellDraw& draw = cell_draws.back();
+        memory.markStart(dodecaplex_buffers);
+        web_pattern.buildArrays(dodecaplex_buffers, memory, include_normals);
+        memory.markEnd(dodecaplex_buffers);
+        draw.count[FULL_WEB] = dodecaplex_buffers.i_head - draw.first[FULL_WEB];
+        draw.corners.insert(draw.corners.end(), memory.corners.begin(), memory.corners.end());
     }
-     
+    // Coarser details index the same vertices, so damage and footprints show at every detail
+    for (int detail = PLAIN_PENTAGON; detail < WEB_DETAILS; detail++) {
+        auto side = map_data.pentagons.begin();
+        for (CellDraw& draw : cell_draws) {
+            draw.first[detail] = dodecaplex_buffers.i_head;
+            for (; side != map_data.pentagons.end() && side->first/SIDES == draw.cell; ++side) {
+                web_pattern.buildIndeces(dodecaplex_buffers, side->second, (WebDetail) detail);
+            }
+            draw.count[detail] = dodecaplex_buffers.i_head - draw.first[detail];
+        }
+    }
+    draw_order.resize(cell_draws.size());
+    for (int i = 0; i < (int) draw_order.size(); i++) draw_order[i] = i;
+    
     dodecaplex_vao = VAO(dodecaplex_buffers);
+    dodecaplex_normals = include_normals;
     if (include_normals) {
         dodecaplex_vao.LinkVecs({4,3,4}, 11);
     } else {        
@@ -179,6 +198,18 @@ void PlayerContext::populateDodecaplexVAO(RhombusPattern web_pattern, bool inclu
     }
 };
 
+void PlayerContext::shareDodecaplexVAO(const PlayerContext& source){
+    cell_draws = source.cell_draws;
+    draw_order = source.draw_order;
+    dodecaplex_normals = source.dodecaplex_normals;
+    dodecaplex_vao = VAO(source.dodecaplex_vao.vbo, source.dodecaplex_vao.ebo);
+    if (dodecaplex_normals) {
+        dodecaplex_vao.LinkVecs({4,3,4}, 11);
+    } else {
+        dodecaplex_vao.LinkVecs({4,3}, 7);
+    }
+};
+
 void PlayerContext::populateDodecaplexVAO(RhombusPattern web_pattern){
     populateDodecaplexVAO(web_pattern, false);
 };
@@ -316,8 +347,69 @@ void PlayerContext::elapseGrowth(float progress){
         }
     }
 };
+void PlayerContext::viewCells(mat4 world, mat4 camera, vec2 viewport, float min_px){
+    for (CellDraw& draw : cell_draws) {
+        // Cells wrapping out through infinity are drawn last
+        vec4 center = world*dodecaplex_centroids[draw.cell];
+        if (ROOT_FIVE+center.w < 0.01f) {
+            draw.distance = 1e9f;
+        } else {
+            center = projectPoint(center);
+            draw.distance = length(vec3(center.x, center.y, center.z));
+        }
+
+        draw.detail = WebDetail::FULL_WEB;
+        if (min_px <= 0.0f) continue;
+        // The corners go through projection.glsl's project() and the camera, as the vertex shader
+        // would take them, and the cell is measured by the box they cover on screen
+        vec2 low(1e9f), high(-1e9f);
+        bool measurable = true;
+        for (const vec4& corner : draw.corners) {
+            vec4 view = world*corner;
+            if (ROOT_FIVE+view.w < 0.01f) { measurable = false; break; } // Projects out to infinity
+            vec4 clip = camera*projectPoint(view);
+            if (clip.w < 0.01f) { measurable = false; break; }  // Reaches behind the eye
+            vec2 ndc = vec2(clip.x, clip.y)/clip.w;
+            low  = glm::min(low, ndc);
+            high = glm::max(high, ndc);
+        }
+        if (!measurable) continue;
+        vec2 span = (high-low)*viewport*0.5f;
+        if (std::max(span.x, span.y) < min_px) draw.detail = WebDetail::PLAIN_PENTAGON;
+    }
+    // Front to back, so the depth test turns away what is hidden before it is shaded
+    sort(draw_order.begin(), draw_order.end(), [this](int a, int b){
+        return cell_draws[a].distance < cell_draws[b].distance;
+    });
+};
 void PlayerContext::drawMainVAO(){
-    dodecaplex_vao.DrawElements(GL_TRIANGLES);
+    drawMainVAO(true);
+};
+void PlayerContext::drawMainVAO(bool background){
+    // Every cell at its detail in draw_order, a run of cells that follow on in the index buffer
+    // being a single range, and then the background quad at the far plane
+    draw_counts.clear();
+    draw_offsets.clear();
+    size_t end = 0;
+    for (int i : draw_order) {
+        const CellDraw& draw = cell_draws[i];
+        GLsizei first = draw.first[draw.detail], count = draw.count[draw.detail];
+        if (!count) continue;
+        if (!draw_counts.empty() && (size_t) first == end) {
+            draw_counts.back() += count;
+        } else {
+            draw_counts.push_back(count);
+            draw_offsets.push_back((const void*) (first*sizeof(GLuint)));
+        }
+        end = first+count;
+    }
+    if (background) {
+        draw_counts.push_back(6);
+        draw_offsets.push_back((const void*) 0);
+    }
+    dodecaplex_vao.Bind();
+    glMultiDrawElements(GL_TRIANGLES, draw_counts.data(), GL_UNSIGNED_INT, draw_offsets.data(), draw_counts.size());
+    dodecaplex_vao.Unbind();
 };
 void PlayerContext::drawShrapnelVAOs(){
     for (int i = 0; i < shrapnel_vaos.size(); i++){     